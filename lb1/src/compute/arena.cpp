@@ -0,0 +1,90 @@
+#include "arena.h"
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+namespace
+{
+    // the buffer starts at a cache line, so blocks of different threads that
+    // are aligned to it don't share one
+    constexpr std::size_t BUFFER_ALIGNMENT = 64;
+
+    std::byte *allocate_buffer(std::size_t size)
+    {
+        return static_cast<std::byte*>(::operator new(size, std::align_val_t(BUFFER_ALIGNMENT)));
+    }
+
+    void free_buffer(std::byte *buffer)
+    {
+        ::operator delete(buffer, std::align_val_t(BUFFER_ALIGNMENT));
+    }
+}
+
+FrameArena::FrameArena(std::size_t size) : _buffer{allocate_buffer(size)}, _capacity{size}
+{
+}
+
+FrameArena::~FrameArena()
+{
+    reset();
+    free_buffer(_buffer);
+}
+
+void FrameArena::reset()
+{
+    for(const auto &[block, alignment] : _overflow)
+        ::operator delete(block, std::align_val_t(alignment));
+    _overflow.clear();
+
+    // the last step didn't fit: the next ones get a buffer for all of it
+    if(_overflow_bytes > 0) {
+        const std::size_t capacity = std::max(_capacity * 2, used());
+        free_buffer(_buffer);
+        _buffer = allocate_buffer(capacity);
+        _capacity = capacity;
+        _overflow_bytes = 0;
+    }
+    _offset.store(0, std::memory_order_relaxed);
+}
+
+std::size_t FrameArena::capacity() const
+{
+    return _capacity;
+}
+
+std::size_t FrameArena::used() const
+{
+    return std::min(_offset.load(std::memory_order_relaxed), _capacity) + _overflow_bytes;
+}
+
+void *FrameArena::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+    const std::uintptr_t base = reinterpret_cast<std::uintptr_t>(_buffer);
+    std::size_t offset = _offset.load(std::memory_order_relaxed);
+    while(true) {
+        const std::size_t begin = ((base + offset + alignment - 1) & ~(alignment - 1)) - base;
+        const std::size_t end = begin + bytes;
+        if(end > _capacity)
+            break;
+        if(_offset.compare_exchange_weak(offset, end, std::memory_order_relaxed))
+            return _buffer + begin;
+    }
+
+    // the buffer is full, the rest of the step gets blocks of its own
+    _offset.store(_capacity, std::memory_order_relaxed);
+    void *block = ::operator new(bytes, std::align_val_t(alignment));
+    std::lock_guard<std::mutex> lock(_overflow_mutex);
+    _overflow.emplace_back(block, alignment);
+    _overflow_bytes += bytes;
+    return block;
+}
+
+void FrameArena::do_deallocate(void *, std::size_t, std::size_t)
+{
+    // freed all at once by reset()
+}
+
+bool FrameArena::do_is_equal(const std::pmr::memory_resource &other) const noexcept
+{
+    return this == &other;
+}
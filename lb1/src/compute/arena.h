@@ -0,0 +1,48 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory_resource>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#define FRAME_ARENA_SIZE (1u << 20) // bytes of the first buffer, grows to the peak use of a step
+
+// Bump allocator for data that lives during one step of the simulation.
+// Allocation only moves an offset (atomically, so thread pool tasks may
+// allocate as well) and deallocation does nothing: everything is dropped at
+// once by reset(). What doesn't fit into the buffer goes to separate blocks,
+// and the next reset() replaces the buffer with one large enough for all of
+// it, so in steady state the heap isn't touched.
+// Used through std::pmr containers: std::pmr::vector<T> v(&arena).
+class FrameArena : public std::pmr::memory_resource
+{
+public:
+    explicit FrameArena(std::size_t size = FRAME_ARENA_SIZE);
+    ~FrameArena() override;
+
+    FrameArena(const FrameArena &) = delete;
+    FrameArena &operator=(const FrameArena &) = delete;
+
+    // drops everything allocated since the last reset; no allocation may run
+    // at the same time and nothing allocated before may be used after
+    void reset();
+
+    std::size_t capacity() const;
+    // bytes allocated since the last reset, including the blocks outside the buffer
+    std::size_t used() const;
+
+private:
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+    std::byte *_buffer;
+    std::size_t _capacity;
+    std::atomic<std::size_t> _offset{0};
+
+    // allocations that didn't fit into the buffer, (block, alignment)
+    std::mutex _overflow_mutex;
+    std::vector<std::pair<void*, std::size_t>> _overflow;
+    std::size_t _overflow_bytes = 0;
+};
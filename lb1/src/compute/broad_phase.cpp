@@ -0,0 +1,102 @@
+#include "broad_phase.h"
+#include <cfloat>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    constexpr float INF = std::numeric_limits<float>::infinity();
+
+    // nearest floats not above / not below x
+    float round_down(double x)
+    {
+        const float f = static_cast<float>(x);
+        return (static_cast<double>(f) > x) ? std::nextafter(f, -INF) : f;
+    }
+
+    float round_up(double x)
+    {
+        const float f = static_cast<float>(x);
+        return (static_cast<double>(f) < x) ? std::nextafter(f, INF) : f;
+    }
+}
+
+void broad_phase::clear(Boxes &boxes)
+{
+    for(auto *values : {&boxes.min_x, &boxes.min_y, &boxes.min_z, &boxes.max_x, &boxes.max_y, &boxes.max_z})
+        values->clear();
+    boxes.count = 0;
+}
+
+void broad_phase::add(Boxes &boxes, const glm::dvec3 &min, const glm::dvec3 &max)
+{
+    // a new group of lanes starts with empty boxes (min > max), which overlap nothing
+    if(boxes.count % BROAD_PHASE_LANES == 0) {
+        for(auto *values : {&boxes.min_x, &boxes.min_y, &boxes.min_z})
+            values->resize(values->size() + BROAD_PHASE_LANES, INF);
+        for(auto *values : {&boxes.max_x, &boxes.max_y, &boxes.max_z})
+            values->resize(values->size() + BROAD_PHASE_LANES, -INF);
+    }
+    const std::size_t i = boxes.count++;
+    boxes.min_x[i] = round_down(min.x);
+    boxes.min_y[i] = round_down(min.y);
+    boxes.min_z[i] = round_down(min.z);
+    boxes.max_x[i] = round_up(max.x);
+    boxes.max_y[i] = round_up(max.y);
+    boxes.max_z[i] = round_up(max.z);
+}
+
+void broad_phase::clear(Planes &planes)
+{
+    for(auto *values : {&planes.nx, &planes.ny, &planes.nz, &planes.w})
+        values->clear();
+}
+
+void broad_phase::add(Planes &planes, const glm::dvec4 &plane)
+{
+    planes.nx.push_back(static_cast<float>(plane.x));
+    planes.ny.push_back(static_cast<float>(plane.y));
+    planes.nz.push_back(static_cast<float>(plane.z));
+    planes.w.push_back(static_cast<float>(plane.w));
+}
+
+void broad_phase::overlapping(const Boxes &boxes, unsigned i, std::vector<unsigned> &result)
+{
+    constexpr unsigned L = BROAD_PHASE_LANES;
+    const float min_x = boxes.min_x[i], min_y = boxes.min_y[i], min_z = boxes.min_z[i];
+    const float max_x = boxes.max_x[i], max_y = boxes.max_y[i], max_z = boxes.max_z[i];
+
+    // whole groups of lanes from the one holding i + 1, the padding never overlaps
+    for(std::size_t group = (i + 1) / L * L; group < boxes.count; group += L) {
+        // fixed width loop without branches, compiles to SIMD compares
+        bool overlap[L];
+        for(unsigned l = 0; l < L; l++) {
+            const std::size_t j = group + l;
+            overlap[l] = (j > i) &
+                         (boxes.min_x[j] <= max_x) & (boxes.max_x[j] >= min_x) &
+                         (boxes.min_y[j] <= max_y) & (boxes.max_y[j] >= min_y) &
+                         (boxes.min_z[j] <= max_z) & (boxes.max_z[j] >= min_z);
+        }
+        for(unsigned l = 0; l < L; l++) {
+            if(overlap[l])
+                result.push_back(group + l);
+        }
+    }
+}
+
+void broad_phase::touching(const Boxes &boxes, unsigned i, const Planes &planes, std::vector<unsigned> &result)
+{
+    for(unsigned p = 0; p < planes.w.size(); p++) {
+        // the corner farthest behind the plane
+        const float x = (planes.nx[p] >= 0.0f) ? boxes.min_x[i] : boxes.max_x[i];
+        const float y = (planes.ny[p] >= 0.0f) ? boxes.min_y[i] : boxes.max_y[i];
+        const float z = (planes.nz[p] >= 0.0f) ? boxes.min_z[i] : boxes.max_z[i];
+        const float distance = planes.nx[p] * x + planes.ny[p] * y + planes.nz[p] * z + planes.w[p];
+        // error of the rounded plane and of the float sum is below a few
+        // epsilons of the magnitude of its terms
+        const float magnitude = std::abs(planes.nx[p] * x) + std::abs(planes.ny[p] * y) +
+                                std::abs(planes.nz[p] * z) + std::abs(planes.w[p]);
+        if(distance <= 4.0f * FLT_EPSILON * magnitude)
+            result.push_back(p);
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include <glm/glm.hpp>
+
+#define BROAD_PHASE_LANES 8 // boxes compared at once, floats in a 256-bit SIMD register
+
+// Broad phase on single precision copies of the bounds: twice as many of
+// them fit into a SIMD register as doubles. Boxes are rounded outwards when
+// converted and plane tests get a margin for the rounding of the float
+// arithmetic, so no pair is dropped that the double precision narrow phase
+// could find touching.
+namespace broad_phase
+{
+    // axis aligned boxes, structure of arrays padded to whole groups of
+    // BROAD_PHASE_LANES with empty boxes
+    struct Boxes {
+        std::vector<float> min_x, min_y, min_z;
+        std::vector<float> max_x, max_y, max_z;
+        std::size_t count = 0;
+    };
+
+    // planes n x + w = 0 with unit normals
+    struct Planes {
+        std::vector<float> nx, ny, nz, w;
+    };
+
+    void clear(Boxes &boxes);
+    void add(Boxes &boxes, const glm::dvec3 &min, const glm::dvec3 &max);
+    void clear(Planes &planes);
+    // plane as (n, w), see Plane::get_plane()
+    void add(Planes &planes, const glm::dvec4 &plane);
+
+    // appends every j > i whose box overlaps box i, ascending
+    void overlapping(const Boxes &boxes, unsigned i, std::vector<unsigned> &result);
+    // appends every plane that box i reaches (a corner on the back side), ascending
+    void touching(const Boxes &boxes, unsigned i, const Planes &planes, std::vector<unsigned> &result);
+}
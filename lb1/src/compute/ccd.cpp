@@ -0,0 +1,61 @@
+#include "ccd.h"
+
+template<gjk::HasSupportFunction A, gjk::HasSupportFunction B>
+double ccd::time_of_impact(const A &a, const Motion &motion_a, const B &b, const Motion &motion_b,
+                           double dt, double target_distance)
+{
+    // rotation can't move any point faster than |w| * radius
+    const double angular_bound = glm::length(motion_a.angular_velocity) * motion_a.radius +
+                                 glm::length(motion_b.angular_velocity) * motion_b.radius;
+    const glm::dvec3 relative_velocity = motion_b.velocity - motion_a.velocity;
+
+    gjk::Simplex simplex;
+    double t = 0.0;
+    for(unsigned i = 0; i < CCD_MAX_ITERATIONS; i++) {
+        const Moving<A> moved_a(a, motion_a, t);
+        const Moving<B> moved_b(b, motion_b, t);
+        const gjk::Result result = gjk::distance(moved_a, moved_b, simplex);
+        if(result.intersecting || result.distance <= target_distance)
+            return t;
+
+        // normal points from B towards A: approaching means B moving along it
+        const double approach_bound = glm::dot(relative_velocity, result.normal) + angular_bound;
+        if(approach_bound <= 0.0)
+            return dt;
+
+        t += (result.distance - target_distance) / approach_bound;
+        if(t >= dt)
+            return dt;
+    }
+    return t;
+}
+
+template<gjk::HasSupportFunction T>
+double ccd::time_of_impact(const T &shape, const Motion &motion, const glm::dvec4 &plane,
+                           double dt, double target_distance)
+{
+    // the plane doesn't turn, so the bound is the same at every iteration
+    const glm::dvec3 normal(plane);
+    const double approach_bound = -glm::dot(motion.velocity, normal) +
+                                  glm::length(motion.angular_velocity) * motion.radius;
+    if(approach_bound <= 0.0)
+        return dt;
+
+    double t = 0.0;
+    for(unsigned i = 0; i < CCD_MAX_ITERATIONS; i++) {
+        const Moving<T> moved(shape, motion, t);
+        const double distance = glm::dot(normal, moved.support(-normal)) + plane.w;
+        if(distance <= target_distance)
+            return t;
+
+        t += (distance - target_distance) / approach_bound;
+        if(t >= dt)
+            return dt;
+    }
+    return t;
+}
+
+// Explicit instantiation to compile function templates
+#include "../model/cube.h"
+template double ccd::time_of_impact<Cube, Cube>(const Cube&, const Motion&, const Cube&, const Motion&, double, double);
+template double ccd::time_of_impact<Cube>(const Cube&, const Motion&, const glm::dvec4&, double, double);
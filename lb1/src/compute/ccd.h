@@ -0,0 +1,56 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include "gjk.h"
+
+#define CCD_MAX_ITERATIONS 32
+
+// Continuous collision detection by conservative advancement (Mirtich).
+// Bodies are assumed to move with constant linear and angular velocity during
+// the step. At every iteration GJK gives the distance d and the normal n, and
+// the shapes are advanced by d / (upper bound of the approach speed along n):
+// they can't touch earlier than that.
+namespace ccd
+{
+    struct Motion {
+        glm::dvec3 center; // center of mass, the shape rotates around it
+        glm::dvec3 velocity;
+        glm::dvec3 angular_velocity;
+        double radius;     // max distance of a point of the shape from the center
+    };
+
+    // shape moved from its current pose by its motion during time t
+    template<gjk::HasSupportFunction T>
+    struct Moving {
+        const T &shape;
+        glm::dvec3 center;
+        glm::dvec3 translation;
+        glm::dmat3x3 rotation;
+
+        Moving(const T &shape, const Motion &motion, double t) :
+            shape{shape}, center{motion.center}, translation{motion.velocity * t}, rotation{1.0}
+        {
+            const double speed = glm::length(motion.angular_velocity);
+            if(speed > 0.0)
+                rotation = glm::mat3_cast(glm::angleAxis(speed * t, motion.angular_velocity / speed));
+        }
+
+        glm::dvec3 support(const glm::dvec3 &direction) const
+        {
+            const glm::dvec3 point = shape.support(glm::transpose(rotation) * direction);
+            return center + translation + rotation * (point - center);
+        }
+    };
+
+    // first time in [0, dt] when the distance between the shapes drops to
+    // target_distance, dt if they don't get that close during the step
+    template<gjk::HasSupportFunction A, gjk::HasSupportFunction B>
+    double time_of_impact(const A &a, const Motion &motion_a, const B &b, const Motion &motion_b,
+                          double dt, double target_distance);
+
+    // same against the static plane (n, w), dot(n, x) + w = signed distance:
+    // the distance is that of the deepest point of the shape, support(-n)
+    template<gjk::HasSupportFunction T>
+    double time_of_impact(const T &shape, const Motion &motion, const glm::dvec4 &plane,
+                          double dt, double target_distance);
+}
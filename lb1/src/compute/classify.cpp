@@ -0,0 +1,73 @@
+#include "classify.h"
+#include <algorithm>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    // vertices as arrays of coordinates
+    struct Vertices {
+        alignas(32) double x[CLASSIFY_VERTICES], y[CLASSIFY_VERTICES], z[CLASSIFY_VERTICES];
+    };
+
+    inline Vertices transpose(const std::array<glm::dvec3, CLASSIFY_VERTICES> &vertices)
+    {
+        Vertices result;
+        for(unsigned v = 0; v < CLASSIFY_VERTICES; v++) {
+            result.x[v] = vertices[v].x;
+            result.y[v] = vertices[v].y;
+            result.z[v] = vertices[v].z;
+        }
+        return result;
+    }
+
+    // distances of all vertices to one plane, returns the outside mask
+    inline std::uint8_t classify_plane(const glm::dvec4 &plane, const Vertices &vertices,
+                                       double epsilon, double *distance)
+    {
+#ifdef __AVX2__
+        const __m256d nx = _mm256_set1_pd(plane.x);
+        const __m256d ny = _mm256_set1_pd(plane.y);
+        const __m256d nz = _mm256_set1_pd(plane.z);
+        const __m256d w = _mm256_set1_pd(plane.w);
+        const __m256d eps = _mm256_set1_pd(epsilon);
+        unsigned mask = 0;
+        for(unsigned v = 0; v < CLASSIFY_VERTICES; v += 4) {
+            __m256d d = _mm256_fmadd_pd(nx, _mm256_load_pd(vertices.x + v), w);
+            d = _mm256_fmadd_pd(ny, _mm256_load_pd(vertices.y + v), d);
+            d = _mm256_fmadd_pd(nz, _mm256_load_pd(vertices.z + v), d);
+            _mm256_store_pd(distance + v, d);
+            mask |= _mm256_movemask_pd(_mm256_cmp_pd(d, eps, _CMP_GT_OQ)) << v;
+        }
+        return mask;
+#else
+        unsigned mask = 0;
+        for(unsigned v = 0; v < CLASSIFY_VERTICES; v++)
+            distance[v] = plane.x * vertices.x[v] + plane.y * vertices.y[v] + plane.z * vertices.z[v] + plane.w;
+        for(unsigned v = 0; v < CLASSIFY_VERTICES; v++)
+            mask |= unsigned(distance[v] > epsilon) << v;
+        return mask;
+#endif
+    }
+}
+
+void classify::classify(const std::array<glm::dvec4, CLASSIFY_PLANES> &planes,
+                        const std::array<glm::dvec3, CLASSIFY_VERTICES> &vertices,
+                        double epsilon, Result &result)
+{
+    const Vertices soa = transpose(vertices);
+    for(unsigned p = 0; p < CLASSIFY_PLANES; p++)
+        result.outside[p] = classify_plane(planes[p], soa, epsilon, result.distance[p]);
+}
+
+std::uint8_t classify::outside(const glm::dvec4 &plane, const std::array<glm::dvec3, CLASSIFY_VERTICES> &vertices,
+                               double epsilon, double *distance)
+{
+    alignas(32) double result[CLASSIFY_VERTICES];
+    const std::uint8_t mask = classify_plane(plane, transpose(vertices), epsilon, result);
+    if(distance != nullptr)
+        std::copy(result, result + CLASSIFY_VERTICES, distance);
+    return mask;
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+#define CLASSIFY_PLANES   6
+#define CLASSIFY_VERTICES 8
+
+// Signed distances of the 8 vertices of a box to the 6 face planes of
+// another one, all at once. Vertices are transposed into arrays of x, y
+// and z, so a plane costs 3 multiply-adds per 4 vertices with AVX2
+// (__AVX2__, see PHYSSYM_AVX2 in CMakeLists.txt) and the lane loops of
+// the portable version vectorize the same way.
+namespace classify
+{
+    struct Result {
+        // distance[p][v] = dot(normal_p, vertex_v) + w_p, positive outside
+        alignas(32) double distance[CLASSIFY_PLANES][CLASSIFY_VERTICES];
+        // bit v of outside[p] is set if vertex v is farther than epsilon outside plane p
+        std::array<std::uint8_t, CLASSIFY_PLANES> outside;
+    };
+
+    constexpr std::uint8_t ALL_OUTSIDE = (1u << CLASSIFY_VERTICES) - 1;
+
+    // planes as returned by Cube::get_faces(), vertices by Cube::get_vertices()
+    void classify(const std::array<glm::dvec4, CLASSIFY_PLANES> &planes,
+                  const std::array<glm::dvec3, CLASSIFY_VERTICES> &vertices,
+                  double epsilon, Result &result);
+
+    // outside mask of a single plane, signed distances are written to
+    // distance[CLASSIFY_VERTICES] if given
+    std::uint8_t outside(const glm::dvec4 &plane, const std::array<glm::dvec3, CLASSIFY_VERTICES> &vertices,
+                         double epsilon, double *distance = nullptr);
+}
@@ -0,0 +1,495 @@
+#include "gjk.h"
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    using bary_t = std::array<double, 4>;
+
+    template<gjk::HasSupportFunction A, gjk::HasSupportFunction B>
+    gjk::SupportPoint make_support(const A &a, const B &b, const glm::dvec3 &dir)
+    {
+        gjk::SupportPoint p;
+        p.dir = dir;
+        p.a = a.support(dir);
+        p.b = b.support(-dir);
+        p.v = p.a - p.b;
+        return p;
+    }
+
+    glm::dvec3 combine(const gjk::Simplex &s, const bary_t &bary)
+    {
+        glm::dvec3 result = {0.0, 0.0, 0.0};
+        for(unsigned i = 0; i < s.size; i++)
+            result += s.points[i].v * bary[i];
+        return result;
+    }
+
+    // All closest_* functions find the point of the feature closest to the origin,
+    // write the smallest sub-simplex containing it to out and its barycentric
+    // coordinates to bary.
+    void closest_segment(const gjk::SupportPoint &p0, const gjk::SupportPoint &p1,
+                         gjk::Simplex &out, bary_t &bary)
+    {
+        const glm::dvec3 ab = p1.v - p0.v;
+        const double len2 = glm::dot(ab, ab);
+        const double t = (len2 > GJK_TOLERANCE * GJK_TOLERANCE) ? glm::dot(-p0.v, ab) / len2 : 0.0;
+
+        if(t <= 0.0) {
+            out.points[0] = p0; out.size = 1; bary = {1.0, 0.0, 0.0, 0.0};
+        }
+        else if(t >= 1.0) {
+            out.points[0] = p1; out.size = 1; bary = {1.0, 0.0, 0.0, 0.0};
+        }
+        else {
+            out.points[0] = p0; out.points[1] = p1; out.size = 2;
+            bary = {1.0 - t, t, 0.0, 0.0};
+        }
+    }
+
+    // Ericson, "Real-Time Collision Detection", 5.1.5
+    void closest_triangle(const gjk::SupportPoint &p0, const gjk::SupportPoint &p1,
+                          const gjk::SupportPoint &p2, gjk::Simplex &out, bary_t &bary)
+    {
+        const glm::dvec3 &a = p0.v, &b = p1.v, &c = p2.v;
+        const glm::dvec3 ab = b - a;
+        const glm::dvec3 ac = c - a;
+
+        const double d1 = glm::dot(ab, -a);
+        const double d2 = glm::dot(ac, -a);
+        if(d1 <= 0.0 && d2 <= 0.0) {
+            out.points[0] = p0; out.size = 1; bary = {1.0, 0.0, 0.0, 0.0};
+            return;
+        }
+
+        const double d3 = glm::dot(ab, -b);
+        const double d4 = glm::dot(ac, -b);
+        if(d3 >= 0.0 && d4 <= d3) {
+            out.points[0] = p1; out.size = 1; bary = {1.0, 0.0, 0.0, 0.0};
+            return;
+        }
+
+        const double vc = d1 * d4 - d3 * d2;
+        if(vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0) {
+            const double v = d1 / (d1 - d3);
+            out.points[0] = p0; out.points[1] = p1; out.size = 2;
+            bary = {1.0 - v, v, 0.0, 0.0};
+            return;
+        }
+
+        const double d5 = glm::dot(ab, -c);
+        const double d6 = glm::dot(ac, -c);
+        if(d6 >= 0.0 && d5 <= d6) {
+            out.points[0] = p2; out.size = 1; bary = {1.0, 0.0, 0.0, 0.0};
+            return;
+        }
+
+        const double vb = d5 * d2 - d1 * d6;
+        if(vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0) {
+            const double w = d2 / (d2 - d6);
+            out.points[0] = p0; out.points[1] = p2; out.size = 2;
+            bary = {1.0 - w, w, 0.0, 0.0};
+            return;
+        }
+
+        const double va = d3 * d6 - d5 * d4;
+        if(va <= 0.0 && (d4 - d3) >= 0.0 && (d5 - d6) >= 0.0) {
+            const double w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+            out.points[0] = p1; out.points[1] = p2; out.size = 2;
+            bary = {1.0 - w, w, 0.0, 0.0};
+            return;
+        }
+
+        const double sum = va + vb + vc;
+        if(std::abs(sum) <= GJK_TOLERANCE * GJK_TOLERANCE) {
+            // degenerate (flat) triangle, the closest point lies on one of its edges
+            gjk::Simplex best, tmp;
+            bary_t best_bary, tmp_bary;
+            double best_dist = std::numeric_limits<double>::infinity();
+            const std::array<std::pair<const gjk::SupportPoint*, const gjk::SupportPoint*>, 3> edges = {
+                std::make_pair(&p0, &p1), std::make_pair(&p0, &p2), std::make_pair(&p1, &p2)
+            };
+            for(const auto &edge : edges) {
+                closest_segment(*edge.first, *edge.second, tmp, tmp_bary);
+                const glm::dvec3 v = combine(tmp, tmp_bary);
+                if(glm::dot(v, v) < best_dist) {
+                    best_dist = glm::dot(v, v);
+                    best = tmp;
+                    best_bary = tmp_bary;
+                }
+            }
+            out = best;
+            bary = best_bary;
+            return;
+        }
+
+        const double v = vb / sum;
+        const double w = vc / sum;
+        out.points[0] = p0; out.points[1] = p1; out.points[2] = p2; out.size = 3;
+        bary = {1.0 - v - w, v, w, 0.0};
+    }
+
+    // returns true if the origin is inside of the tetrahedron
+    bool closest_tetrahedron(const gjk::Simplex &s, gjk::Simplex &out, bary_t &bary)
+    {
+        // every face together with the opposite vertex
+        const std::array<std::array<unsigned, 4>, 4> faces = {{
+            {0, 1, 2, 3}, {0, 2, 3, 1}, {0, 3, 1, 2}, {1, 3, 2, 0}
+        }};
+
+        bool inside = true;
+        double best_dist = std::numeric_limits<double>::infinity();
+        for(const auto &face : faces) {
+            const glm::dvec3 &a = s.points[face[0]].v;
+            const glm::dvec3 normal = glm::cross(s.points[face[1]].v - a, s.points[face[2]].v - a);
+            const double sign_origin = glm::dot(-a, normal);
+            const double sign_vertex = glm::dot(s.points[face[3]].v - a, normal);
+
+            // origin and the opposite vertex are on the same side of this face
+            if(sign_origin * sign_vertex > 0.0 &&
+               std::abs(sign_vertex) > GJK_TOLERANCE * GJK_TOLERANCE)
+                continue;
+
+            inside = false;
+            gjk::Simplex tmp;
+            bary_t tmp_bary;
+            closest_triangle(s.points[face[0]], s.points[face[1]], s.points[face[2]], tmp, tmp_bary);
+            const glm::dvec3 v = combine(tmp, tmp_bary);
+            if(glm::dot(v, v) < best_dist) {
+                best_dist = glm::dot(v, v);
+                out = tmp;
+                bary = tmp_bary;
+            }
+        }
+
+        if(inside) {
+            out = s;
+            bary = {0.25, 0.25, 0.25, 0.25};
+        }
+        return inside;
+    }
+
+    // reduces the simplex to the feature closest to the origin, returns the closest point
+    glm::dvec3 closest(gjk::Simplex &s, bary_t &bary, bool &inside)
+    {
+        gjk::Simplex out;
+        inside = false;
+        switch(s.size) {
+        case 1:
+            out = s;
+            bary = {1.0, 0.0, 0.0, 0.0};
+            break;
+        case 2:
+            closest_segment(s.points[0], s.points[1], out, bary);
+            break;
+        case 3:
+            closest_triangle(s.points[0], s.points[1], s.points[2], out, bary);
+            break;
+        case 4:
+            inside = closest_tetrahedron(s, out, bary);
+            break;
+        }
+        s = out;
+        return combine(s, bary);
+    }
+
+    bool contains(const gjk::Simplex &s, const glm::dvec3 &v)
+    {
+        for(unsigned i = 0; i < s.size; i++) {
+            const glm::dvec3 diff = s.points[i].v - v;
+            if(glm::dot(diff, diff) <= GJK_TOLERANCE * GJK_TOLERANCE)
+                return true;
+        }
+        return false;
+    }
+
+    void fill_witness(gjk::Result &result, const gjk::Simplex &s, const bary_t &bary)
+    {
+        result.point_a = {0.0, 0.0, 0.0};
+        result.point_b = {0.0, 0.0, 0.0};
+        for(unsigned i = 0; i < s.size; i++) {
+            result.point_a += s.points[i].a * bary[i];
+            result.point_b += s.points[i].b * bary[i];
+        }
+    }
+
+    // EPA needs a tetrahedron to start with. GJK may stop with a smaller simplex
+    // if the shapes are only touching, so add vertices until it is full.
+    template<gjk::HasSupportFunction A, gjk::HasSupportFunction B>
+    bool build_tetrahedron(const A &a, const B &b, std::pmr::vector<gjk::SupportPoint> &vertices)
+    {
+        const std::array<glm::dvec3, 6> axes = {
+            glm::dvec3( 1.0,  0.0,  0.0), glm::dvec3(-1.0,  0.0,  0.0),
+            glm::dvec3( 0.0,  1.0,  0.0), glm::dvec3( 0.0, -1.0,  0.0),
+            glm::dvec3( 0.0,  0.0,  1.0), glm::dvec3( 0.0,  0.0, -1.0)
+        };
+        const double eps = EPA_TOLERANCE;
+
+        if(vertices.size() == 1) {
+            for(const auto &axis : axes) {
+                const gjk::SupportPoint p = make_support(a, b, axis);
+                if(glm::length(p.v - vertices[0].v) > eps) {
+                    vertices.push_back(p);
+                    break;
+                }
+            }
+        }
+
+        if(vertices.size() == 2) {
+            const glm::dvec3 line = glm::normalize(vertices[1].v - vertices[0].v);
+            for(std::size_t i = 0; i < axes.size() && vertices.size() == 2; i++) {
+                const glm::dvec3 perp = glm::cross(line, axes[i]);
+                if(glm::length(perp) < eps)
+                    continue;
+                const gjk::SupportPoint p = make_support(a, b, perp);
+                const glm::dvec3 offset = p.v - vertices[0].v;
+                if(glm::length(offset - line * glm::dot(offset, line)) > eps)
+                    vertices.push_back(p);
+            }
+        }
+
+        if(vertices.size() == 3) {
+            const glm::dvec3 normal = glm::normalize(glm::cross(vertices[1].v - vertices[0].v,
+                                                                vertices[2].v - vertices[0].v));
+            for(const double sign : {1.0, -1.0}) {
+                const gjk::SupportPoint p = make_support(a, b, normal * sign);
+                if(std::abs(glm::dot(p.v - vertices[0].v, normal)) > eps) {
+                    vertices.push_back(p);
+                    break;
+                }
+            }
+        }
+
+        return vertices.size() == 4;
+    }
+
+    // triangle of the EPA polytope
+    struct Face {
+        std::array<unsigned, 3> idx;
+        glm::dvec3 normal; // outward
+        double dist;       // distance from the origin to the plane of the face
+    };
+
+    // a closed triangle mesh with V vertices has 2 V - 4 faces and 3 V - 6 edges
+    constexpr std::size_t EPA_MAX_VERTICES = 4 + EPA_MAX_ITERATIONS;
+    constexpr std::size_t EPA_MAX_FACES = 2 * EPA_MAX_VERTICES;
+    constexpr std::size_t EPA_MAX_EDGES = 3 * EPA_MAX_VERTICES;
+    constexpr std::size_t EPA_BUFFER_SIZE = EPA_MAX_VERTICES * sizeof(gjk::SupportPoint) +
+                                            EPA_MAX_FACES * sizeof(Face) +
+                                            EPA_MAX_EDGES * sizeof(std::pair<unsigned, unsigned>) +
+                                            3 * alignof(std::max_align_t);
+}
+
+template<gjk::HasSupportFunction A, gjk::HasSupportFunction B>
+gjk::Result gjk::distance(const A &a, const B &b, Simplex &simplex)
+{
+    Result result;
+
+    // warm start: re-evaluate the previous simplex at the current positions of the shapes
+    Simplex current;
+    for(unsigned i = 0; i < simplex.size; i++) {
+        const SupportPoint p = make_support(a, b, simplex.points[i].dir);
+        if(!contains(current, p.v))
+            current.points[current.size++] = p;
+    }
+    if(current.size == 0)
+        current.points[current.size++] = make_support(a, b, glm::dvec3(1.0, 0.0, 0.0));
+
+    bary_t bary;
+    bool inside;
+    glm::dvec3 v = closest(current, bary, inside);
+
+    while(!inside && result.iterations < GJK_MAX_ITERATIONS) {
+        ++result.iterations;
+        const double v2 = glm::dot(v, v);
+        if(v2 <= GJK_TOLERANCE * GJK_TOLERANCE) {
+            // origin lies on the simplex: shapes are touching
+            inside = true;
+            break;
+        }
+
+        const SupportPoint w = make_support(a, b, -v);
+        // no further progress towards the origin, v is the closest point
+        if(v2 - glm::dot(v, w.v) <= GJK_TOLERANCE * v2 || contains(current, w.v))
+            break;
+
+        current.points[current.size++] = w;
+        v = closest(current, bary, inside);
+    }
+    simplex = current;
+
+    fill_witness(result, current, bary);
+    if(inside) {
+        result.intersecting = true;
+        return result;
+    }
+
+    result.distance = glm::length(v);
+    result.normal = v / result.distance;
+    return result;
+}
+
+template<gjk::HasSupportFunction A, gjk::HasSupportFunction B>
+gjk::Result gjk::penetration(const A &a, const B &b, const Simplex &simplex)
+{
+    Result result;
+    result.intersecting = true;
+
+    // the polytope lives on the stack, the heap is only used if it outgrows
+    // the bounds above (broken topology)
+    alignas(std::max_align_t) std::byte buffer[EPA_BUFFER_SIZE];
+    std::pmr::monotonic_buffer_resource memory(buffer, sizeof(buffer));
+    std::pmr::vector<SupportPoint> vertices(&memory);
+    std::pmr::vector<Face> faces(&memory);
+    std::pmr::vector<std::pair<unsigned, unsigned>> horizon(&memory);
+    vertices.reserve(EPA_MAX_VERTICES);
+    faces.reserve(EPA_MAX_FACES);
+    horizon.reserve(EPA_MAX_EDGES);
+
+    // degenerate case (e.g. two faces exactly touching): zero depth
+    auto touching = [&]() {
+        if(!vertices.empty()) {
+            result.point_a = vertices[0].a;
+            result.point_b = vertices[0].b;
+        }
+        return result;
+    };
+
+    vertices.assign(simplex.points.begin(), simplex.points.begin() + simplex.size);
+    if(vertices.empty() || !build_tetrahedron(a, b, vertices))
+        return touching();
+
+    // any interior point, used to orient the faces outwards
+    const glm::dvec3 inner = (vertices[0].v + vertices[1].v + vertices[2].v + vertices[3].v) / 4.0;
+
+    auto add_face = [&](unsigned i0, unsigned i1, unsigned i2) {
+        Face face{{i0, i1, i2}, glm::cross(vertices[i1].v - vertices[i0].v,
+                                           vertices[i2].v - vertices[i0].v), 0.0};
+        const double len = glm::length(face.normal);
+        if(len <= GJK_TOLERANCE * GJK_TOLERANCE) {
+            // sliver face, keep it for topology but never pick it as the closest one
+            face.dist = std::numeric_limits<double>::infinity();
+            faces.push_back(face);
+            return;
+        }
+        face.normal /= len;
+        if(glm::dot(face.normal, vertices[i0].v - inner) < 0.0) {
+            face.normal = -face.normal;
+            std::swap(face.idx[1], face.idx[2]);
+        }
+        face.dist = glm::dot(face.normal, vertices[i0].v);
+        faces.push_back(face);
+    };
+
+    add_face(0, 1, 2);
+    add_face(0, 3, 1);
+    add_face(0, 2, 3);
+    add_face(1, 3, 2);
+
+    auto closest_face = [&faces]() {
+        std::size_t best = 0;
+        for(std::size_t i = 1; i < faces.size(); i++) {
+            if(faces[i].dist < faces[best].dist)
+                best = i;
+        }
+        return best;
+    };
+
+    for(unsigned iteration = 0; iteration < EPA_MAX_ITERATIONS; iteration++) {
+        ++result.iterations;
+        const Face face = faces[closest_face()];
+        // only slivers left, there is no direction to expand in
+        if(std::isinf(face.dist))
+            break;
+        const SupportPoint w = make_support(a, b, face.normal);
+        if(glm::dot(w.v, face.normal) - face.dist < EPA_TOLERANCE)
+            break;
+
+        // remove every face visible from the new vertex, keep the horizon edges
+        horizon.clear();
+        for(std::size_t i = faces.size(); i-- > 0;) {
+            if(glm::dot(faces[i].normal, w.v - vertices[faces[i].idx[0]].v) <= 0.0)
+                continue;
+
+            for(unsigned e = 0; e < 3; e++) {
+                const std::pair<unsigned, unsigned> edge = {faces[i].idx[e], faces[i].idx[(e + 1) % 3]};
+                bool shared = false;
+                for(std::size_t h = 0; h < horizon.size(); h++) {
+                    if(horizon[h].first == edge.second && horizon[h].second == edge.first) {
+                        horizon.erase(horizon.begin() + h);
+                        shared = true;
+                        break;
+                    }
+                }
+                if(!shared)
+                    horizon.push_back(edge);
+            }
+            faces.erase(faces.begin() + i);
+        }
+
+        vertices.push_back(w);
+        const unsigned new_index = vertices.size() - 1;
+        for(const auto &edge : horizon)
+            add_face(edge.first, edge.second, new_index);
+
+        if(faces.empty())
+            return touching();
+    }
+
+    const Face &face = faces[closest_face()];
+    if(std::isinf(face.dist))
+        return touching();
+    const SupportPoint &p0 = vertices[face.idx[0]];
+    const SupportPoint &p1 = vertices[face.idx[1]];
+    const SupportPoint &p2 = vertices[face.idx[2]];
+
+    // barycentric coordinates of the origin projection onto the closest face
+    const glm::dvec3 projection = face.normal * face.dist;
+    const glm::dvec3 e0 = p1.v - p0.v;
+    const glm::dvec3 e1 = p2.v - p0.v;
+    const glm::dvec3 ep = projection - p0.v;
+    const double d00 = glm::dot(e0, e0);
+    const double d01 = glm::dot(e0, e1);
+    const double d11 = glm::dot(e1, e1);
+    const double d20 = glm::dot(ep, e0);
+    const double d21 = glm::dot(ep, e1);
+    const double denom = d00 * d11 - d01 * d01;
+    const double v = (d11 * d20 - d01 * d21) / denom;
+    const double w = (d00 * d21 - d01 * d20) / denom;
+    const double u = 1.0 - v - w;
+
+    result.point_a = p0.a * u + p1.a * v + p2.a * w;
+    result.point_b = p0.b * u + p1.b * v + p2.b * w;
+    // A has to move against the face normal to get out of B
+    result.normal = -face.normal;
+    result.depth = face.dist;
+    return result;
+}
+
+template<gjk::HasSupportFunction A, gjk::HasSupportFunction B>
+gjk::Result gjk::collide(const A &a, const B &b, Simplex &simplex)
+{
+    Result result = distance(a, b, simplex);
+    if(!result.intersecting)
+        return result;
+
+    const unsigned gjk_iterations = result.iterations;
+    result = penetration(a, b, simplex);
+    result.iterations += gjk_iterations;
+    return result;
+}
+
+// Explicit instantiation to compile function templates
+#include "../model/cube.h"
+template gjk::Result gjk::distance<Cube, Cube>(const Cube&, const Cube&, gjk::Simplex&);
+template gjk::Result gjk::penetration<Cube, Cube>(const Cube&, const Cube&, const gjk::Simplex&);
+template gjk::Result gjk::collide<Cube, Cube>(const Cube&, const Cube&, gjk::Simplex&);
+template gjk::Result gjk::distance<CubeSupport, CubeSupport>(const CubeSupport&, const CubeSupport&, gjk::Simplex&);
+template gjk::Result gjk::collide<CubeSupport, CubeSupport>(const CubeSupport&, const CubeSupport&, gjk::Simplex&);
+
+#include "ccd.h"
+template gjk::Result gjk::distance<ccd::Moving<Cube>, ccd::Moving<Cube>>(const ccd::Moving<Cube>&, const ccd::Moving<Cube>&, gjk::Simplex&);
@@ -0,0 +1,57 @@
+#pragma once
+#include <array>
+#include <concepts>
+#include <glm/glm.hpp>
+
+#define GJK_MAX_ITERATIONS 32
+#define GJK_TOLERANCE      1e-6
+#define EPA_MAX_ITERATIONS 64
+#define EPA_TOLERANCE      1e-6
+
+// GJK distance / intersection test and EPA penetration depth for any pair of
+// convex shapes. Shapes are described only by their support function:
+// support(d) returns the point of the shape farthest along direction d.
+namespace gjk
+{
+    template<typename T>
+    concept HasSupportFunction = requires(const T t, const glm::dvec3 d) {
+        { t.support(d) } -> std::same_as<glm::dvec3>;
+    };
+
+    // vertex of the Minkowski difference A - B
+    struct SupportPoint {
+        glm::dvec3 v;    // a - b
+        glm::dvec3 a, b; // support points of each shape
+        glm::dvec3 dir;  // search direction that produced this vertex
+    };
+
+    // Simplex is kept between calls (one per pair of bodies). On the next call
+    // its vertices are re-evaluated along the stored directions, so a slowly
+    // moving pair converges in one or two iterations.
+    struct Simplex {
+        std::array<SupportPoint, 4> points;
+        unsigned size = 0;
+    };
+
+    struct Result {
+        bool intersecting = false;
+        double distance = 0.0; // distance between shapes, 0 if intersecting
+        double depth = 0.0;    // penetration depth (EPA), 0 if separated
+        glm::dvec3 normal = {0.0, 0.0, 1.0}; // unit vector pointing from B towards A
+        glm::dvec3 point_a, point_b;         // witness points on A and B
+        unsigned iterations = 0;
+    };
+
+    // GJK: closest points between A and B (or intersection flag)
+    template<HasSupportFunction A, HasSupportFunction B>
+    Result distance(const A &a, const B &b, Simplex &simplex);
+
+    // EPA: penetration depth and normal, simplex must come from distance()
+    // that reported intersection
+    template<HasSupportFunction A, HasSupportFunction B>
+    Result penetration(const A &a, const B &b, const Simplex &simplex);
+
+    // GJK followed by EPA if the shapes intersect
+    template<HasSupportFunction A, HasSupportFunction B>
+    Result collide(const A &a, const B &b, Simplex &simplex);
+}
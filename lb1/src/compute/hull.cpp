@@ -0,0 +1,247 @@
+#include "hull.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <stdexcept>
+
+namespace
+{
+    struct Face {
+        std::array<unsigned, 3> v;
+        glm::dvec3 normal; // unit, outwards
+        double offset;     // dot(normal, x) = offset on the face
+        bool alive = true;
+    };
+
+    Face make_face(const std::vector<glm::dvec3> &points, unsigned a, unsigned b, unsigned c)
+    {
+        Face face;
+        face.v = {a, b, c};
+        face.normal = glm::normalize(glm::cross(points[b] - points[a], points[c] - points[a]));
+        face.offset = glm::dot(face.normal, points[a]);
+        return face;
+    }
+
+    // index of the point farthest from the value given by distance()
+    template<typename F>
+    unsigned farthest(const std::vector<glm::dvec3> &points, F distance)
+    {
+        unsigned result = 0;
+        for(unsigned i = 1; i < points.size(); i++) {
+            if(distance(points[i]) > distance(points[result]))
+                result = i;
+        }
+        return result;
+    }
+}
+
+hull::Hull::Hull(const std::vector<glm::dvec3> &points)
+{
+    _build(points);
+    _compute_mass_properties();
+}
+
+void hull::Hull::_build(const std::vector<glm::dvec3> &points)
+{
+    if(points.size() < 4)
+        throw std::invalid_argument("Convex hull needs at least 4 points!");
+
+    // scale of the cloud for the tolerances
+    glm::dvec3 min = points[0], max = points[0];
+    for(const auto &p : points) {
+        min = glm::min(min, p);
+        max = glm::max(max, p);
+    }
+    const double eps = HULL_TOLERANCE * std::max(glm::length(max - min), 1.0);
+
+    // initial tetrahedron: two far points, the farthest from their line and from their plane
+    const unsigned i0 = farthest(points, [&](const glm::dvec3 &p) { return -p.x; });
+    const unsigned i1 = farthest(points, [&](const glm::dvec3 &p) { return glm::length(p - points[i0]); });
+    const glm::dvec3 line = glm::normalize(points[i1] - points[i0]);
+    const unsigned i2 = farthest(points, [&](const glm::dvec3 &p) {
+        const glm::dvec3 d = p - points[i0];
+        return glm::length(d - line * glm::dot(d, line));
+    });
+    const glm::dvec3 plane = glm::cross(points[i1] - points[i0], points[i2] - points[i0]);
+    const unsigned i3 = farthest(points, [&](const glm::dvec3 &p) { return std::abs(glm::dot(plane, p - points[i0])); });
+    if(glm::length(points[i1] - points[i0]) <= eps || glm::length(plane) <= eps * eps ||
+       std::abs(glm::dot(glm::normalize(plane), points[i3] - points[i0])) <= eps)
+        throw std::invalid_argument("Points of the convex hull don't span a volume!");
+
+    std::vector<Face> faces;
+    // directed edge -> face that has it, kept for the alive faces
+    std::map<std::pair<unsigned, unsigned>, unsigned> edge_faces;
+    auto add_face = [&](unsigned a, unsigned b, unsigned c) {
+        faces.push_back(make_face(points, a, b, c));
+        const unsigned index = faces.size() - 1;
+        edge_faces[{a, b}] = index;
+        edge_faces[{b, c}] = index;
+        edge_faces[{c, a}] = index;
+    };
+
+    // faces of the tetrahedron, turned away from its fourth vertex
+    const bool flip = glm::dot(plane, points[i3] - points[i0]) > 0.0;
+    const unsigned tetra[4][3] = {{i0, i1, i2}, {i0, i3, i1}, {i1, i3, i2}, {i2, i3, i0}};
+    for(const auto &f : tetra) {
+        if(flip)
+            add_face(f[0], f[2], f[1]);
+        else
+            add_face(f[0], f[1], f[2]);
+    }
+
+    for(unsigned p = 0; p < points.size(); p++) {
+        if(p == i0 || p == i1 || p == i2 || p == i3)
+            continue;
+
+        std::vector<unsigned> visible;
+        for(unsigned f = 0; f < faces.size(); f++) {
+            if(faces[f].alive && glm::dot(faces[f].normal, points[p]) - faces[f].offset > eps)
+                visible.push_back(f);
+        }
+        // inside the current hull
+        if(visible.empty())
+            continue;
+
+        // horizon: edges of visible faces whose other face stays
+        std::vector<std::pair<unsigned, unsigned>> horizon;
+        for(const unsigned f : visible)
+            faces[f].alive = false;
+        for(const unsigned f : visible) {
+            for(unsigned k = 0; k < 3; k++) {
+                const unsigned a = faces[f].v[k], b = faces[f].v[(k + 1) % 3];
+                if(faces[edge_faces.at({b, a})].alive)
+                    horizon.emplace_back(a, b);
+            }
+        }
+        for(const unsigned f : visible) {
+            for(unsigned k = 0; k < 3; k++)
+                edge_faces.erase({faces[f].v[k], faces[f].v[(k + 1) % 3]});
+        }
+        // the new faces keep the orientation of the removed ones
+        for(const auto &[a, b] : horizon)
+            add_face(a, b, p);
+    }
+
+    // keep only the vertices of the hull
+    std::vector<unsigned> index(points.size(), unsigned(points.size()));
+    for(const auto &face : faces) {
+        if(!face.alive)
+            continue;
+        std::array<unsigned, 3> triangle;
+        for(unsigned k = 0; k < 3; k++) {
+            if(index[face.v[k]] == points.size()) {
+                index[face.v[k]] = _vertices.size();
+                _vertices.push_back(points[face.v[k]]);
+            }
+            triangle[k] = index[face.v[k]];
+        }
+        _triangles.push_back(triangle);
+    }
+
+    _neighbors.assign(_vertices.size(), {});
+    for(const auto &triangle : _triangles) {
+        for(unsigned k = 0; k < 3; k++)
+            _neighbors[triangle[k]].push_back(triangle[(k + 1) % 3]);
+    }
+    for(auto &neighbors : _neighbors) {
+        std::sort(neighbors.begin(), neighbors.end());
+        neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+    }
+}
+
+void hull::Hull::_compute_mass_properties()
+{
+    // Divergence theorem: the volume integrals become a sum over tetrahedra
+    // spanned by the origin and every surface triangle, signed by orientation.
+    // Second moments of a tetrahedron (0, a, b, c):
+    // C = det / 120 * (A (J + I) A^T), A = [a b c], J = ones
+    _volume = 0.0;
+    glm::dvec3 first_moment(0.0);
+    glm::dmat3x3 covariance(0.0);
+    for(const auto &triangle : _triangles) {
+        const glm::dvec3 &a = _vertices[triangle[0]];
+        const glm::dvec3 &b = _vertices[triangle[1]];
+        const glm::dvec3 &c = _vertices[triangle[2]];
+        const double det = glm::dot(a, glm::cross(b, c));
+
+        _volume += det / 6.0;
+        first_moment += (a + b + c) * (det / 24.0);
+        const glm::dvec3 sum = a + b + c;
+        for(unsigned i = 0; i < 3; i++) {
+            for(unsigned j = 0; j < 3; j++) {
+                covariance[i][j] += det / 120.0 * (a[i] * a[j] + b[i] * b[j] + c[i] * c[j] + sum[i] * sum[j]);
+            }
+        }
+    }
+    _center = first_moment / _volume;
+
+    // move the center of mass to the origin (parallel axis theorem for the covariance)
+    for(unsigned i = 0; i < 3; i++) {
+        for(unsigned j = 0; j < 3; j++)
+            covariance[i][j] -= _volume * _center[i] * _center[j];
+    }
+    for(auto &vertex : _vertices)
+        vertex -= _center;
+
+    // I = trace(C) E - C
+    const double trace = covariance[0][0] + covariance[1][1] + covariance[2][2];
+    _unit_inertia = glm::dmat3x3(trace) - covariance;
+
+    _radius = 0.0;
+    for(const auto &vertex : _vertices)
+        _radius = std::max(_radius, glm::length(vertex));
+}
+
+const std::vector<glm::dvec3> &hull::Hull::vertices() const
+{
+    return _vertices;
+}
+
+const std::vector<std::array<unsigned, 3>> &hull::Hull::triangles() const
+{
+    return _triangles;
+}
+
+const std::vector<std::vector<unsigned>> &hull::Hull::neighbors() const
+{
+    return _neighbors;
+}
+
+unsigned hull::Hull::support(const glm::dvec3 &direction, unsigned start) const
+{
+    // on a convex polyhedron a vertex with no better neighbor is the farthest one
+    unsigned current = (start < _vertices.size()) ? start : 0;
+    double best = glm::dot(_vertices[current], direction);
+    for(bool improved = true; improved;) {
+        improved = false;
+        for(const unsigned neighbor : _neighbors[current]) {
+            const double value = glm::dot(_vertices[neighbor], direction);
+            if(value > best) {
+                best = value;
+                current = neighbor;
+                improved = true;
+            }
+        }
+    }
+    return current;
+}
+
+double hull::Hull::volume() const
+{
+    return _volume;
+}
+
+glm::dvec3 hull::Hull::center() const
+{
+    return _center;
+}
+
+glm::dmat3x3 hull::Hull::inertia_tensor(double mass) const
+{
+    return _unit_inertia * (mass / _volume);
+}
+
+double hull::Hull::radius() const
+{
+    return _radius;
+}
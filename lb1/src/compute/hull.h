@@ -0,0 +1,52 @@
+#pragma once
+#include <array>
+#include <vector>
+#include <glm/glm.hpp>
+
+#define HULL_TOLERANCE 1e-9 // relative to the size of the point cloud
+
+// Convex polyhedra built from a point cloud. The hull keeps the vertex
+// adjacency, so the support point is found by hill climbing from a nearby
+// vertex (usually the one from the last query) instead of a scan of all
+// vertices. Mass properties are computed once, with the divergence theorem.
+namespace hull
+{
+    class Hull
+    {
+    public:
+        // incremental convex hull; points inside it are dropped, the result is
+        // moved so that the center of mass is at the origin.
+        // Throws std::invalid_argument if the points don't span a volume.
+        explicit Hull(const std::vector<glm::dvec3> &points);
+
+        const std::vector<glm::dvec3> &vertices() const;
+        // outward (counter-clockwise seen from outside) triangles
+        const std::vector<std::array<unsigned, 3>> &triangles() const;
+        // vertices connected to each vertex by an edge
+        const std::vector<std::vector<unsigned>> &neighbors() const;
+
+        // index of the vertex farthest along the direction, searched from start
+        unsigned support(const glm::dvec3 &direction, unsigned start = 0) const;
+
+        double volume() const;
+        // offset by which the points were moved (their center of mass before)
+        glm::dvec3 center() const;
+        // about the center of mass, for the given mass
+        glm::dmat3x3 inertia_tensor(double mass) const;
+        // distance of the farthest vertex from the center of mass
+        double radius() const;
+
+    private:
+        std::vector<glm::dvec3> _vertices;
+        std::vector<std::array<unsigned, 3>> _triangles;
+        std::vector<std::vector<unsigned>> _neighbors;
+
+        double _volume;
+        glm::dvec3 _center;
+        glm::dmat3x3 _unit_inertia; // for density 1
+        double _radius;
+
+        void _build(const std::vector<glm::dvec3> &points);
+        void _compute_mass_properties();
+    };
+}
@@ -0,0 +1,257 @@
+#include "impulse_solver.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+
+namespace
+{
+    double relative_velocity(const impulse_solver::Body &a, const impulse_solver::Body &b,
+                             const impulse_solver::Constraint &c)
+    {
+        const glm::dvec3 va = a.velocity + glm::cross(a.angular_velocity, c.ra);
+        const glm::dvec3 vb = b.velocity + glm::cross(b.angular_velocity, c.rb);
+        return glm::dot(c.normal, va - vb);
+    }
+
+    void apply(impulse_solver::Body &a, impulse_solver::Body &b,
+               const impulse_solver::Constraint &c, double impulse)
+    {
+        const glm::dvec3 p = c.normal * impulse;
+        const glm::dvec3 angular_a = glm::cross(c.ra, p);
+        const glm::dvec3 angular_b = glm::cross(c.rb, p);
+
+        a.velocity += p * a.inv_mass;
+        a.angular_velocity += a.inv_inertia * angular_a;
+        a.linear_impulse += p;
+        a.angular_impulse += angular_a;
+
+        b.velocity -= p * b.inv_mass;
+        b.angular_velocity -= b.inv_inertia * angular_b;
+        b.linear_impulse -= p;
+        b.angular_impulse -= angular_b;
+    }
+
+    // one Gauss-Seidel update of a constraint, returns the velocity change
+    double solve_one(std::span<impulse_solver::Body> bodies, impulse_solver::Constraint &c)
+    {
+        impulse_solver::Body &a = bodies[c.body_a];
+        impulse_solver::Body &b = bodies[c.body_b];
+
+        // accumulated impulse can only push the bodies apart, so it is clamped
+        // at zero; this also cancels a warm start that is no longer needed
+        const double delta = c.eff_mass * (c.target - relative_velocity(a, b, c));
+        const double accumulated = std::max(c.impulse + delta, 0.0);
+        const double applied = accumulated - c.impulse;
+        c.impulse = accumulated;
+
+        if(applied == 0.0)
+            return 0.0;
+        apply(a, b, c, applied);
+        return std::abs(applied) / std::max(c.eff_mass, 1e-12);
+    }
+
+    // Gauss-Seidel update of up to SOLVER_LANES constraints that share no bodies.
+    // Data is gathered into arrays of lanes, so the arithmetic in between
+    // compiles to SIMD instructions; unused lanes have zero effective mass.
+    double solve_lanes(std::span<impulse_solver::Body> bodies, std::span<impulse_solver::Constraint> constraints,
+                       const unsigned *indices, unsigned count)
+    {
+        constexpr unsigned L = SOLVER_LANES;
+        double n[3][L] = {}, va[3][L] = {}, wa[3][L] = {}, vb[3][L] = {}, wb[3][L] = {};
+        double ra_n[3][L] = {}, rb_n[3][L] = {};
+        double eff_mass[L] = {}, target[L] = {}, impulse[L] = {};
+
+        for(unsigned l = 0; l < count; l++) {
+            const impulse_solver::Constraint &c = constraints[indices[l]];
+            const impulse_solver::Body &a = bodies[c.body_a];
+            const impulse_solver::Body &b = bodies[c.body_b];
+            for(unsigned k = 0; k < 3; k++) {
+                n[k][l] = c.normal[k];
+                va[k][l] = a.velocity[k];
+                wa[k][l] = a.angular_velocity[k];
+                vb[k][l] = b.velocity[k];
+                wb[k][l] = b.angular_velocity[k];
+                ra_n[k][l] = c.ra_n[k];
+                rb_n[k][l] = c.rb_n[k];
+            }
+            eff_mass[l] = c.eff_mass;
+            target[l] = c.target;
+            impulse[l] = c.impulse;
+        }
+
+        // relative normal velocity: n (va - vb) + (ra x n) wa - (rb x n) wb
+        double velocity[L] = {};
+        for(unsigned k = 0; k < 3; k++) {
+            for(unsigned l = 0; l < L; l++)
+                velocity[l] += n[k][l] * (va[k][l] - vb[k][l]) + ra_n[k][l] * wa[k][l] - rb_n[k][l] * wb[k][l];
+        }
+
+        double applied[L];
+        for(unsigned l = 0; l < L; l++) {
+            const double accumulated = std::max(impulse[l] + eff_mass[l] * (target[l] - velocity[l]), 0.0);
+            applied[l] = accumulated - impulse[l];
+            impulse[l] = accumulated;
+        }
+
+        double residual = 0.0;
+        for(unsigned l = 0; l < count; l++) {
+            impulse_solver::Constraint &c = constraints[indices[l]];
+            c.impulse = impulse[l];
+            if(applied[l] == 0.0)
+                continue;
+
+            impulse_solver::Body &a = bodies[c.body_a];
+            impulse_solver::Body &b = bodies[c.body_b];
+            const glm::dvec3 p = c.normal * applied[l];
+            a.velocity += p * a.inv_mass;
+            a.angular_velocity += c.angular_a * applied[l];
+            a.linear_impulse += p;
+            a.angular_impulse += c.ra_n * applied[l];
+            b.velocity -= p * b.inv_mass;
+            b.angular_velocity -= c.angular_b * applied[l];
+            b.linear_impulse -= p;
+            b.angular_impulse -= c.rb_n * applied[l];
+
+            residual = std::max(residual, std::abs(applied[l]) / std::max(c.eff_mass, 1e-12));
+        }
+        return residual;
+    }
+}
+
+void impulse_solver::prepare(std::span<const Body> bodies, Constraint &c,
+                             double restitution, double min_bounce_speed)
+{
+    const Body &a = bodies[c.body_a];
+    const Body &b = bodies[c.body_b];
+
+    c.ra_n = glm::cross(c.ra, c.normal);
+    c.rb_n = glm::cross(c.rb, c.normal);
+    c.angular_a = a.inv_inertia * c.ra_n;
+    c.angular_b = b.inv_inertia * c.rb_n;
+    const double k = a.inv_mass + b.inv_mass +
+                     glm::dot(c.ra_n, c.angular_a) +
+                     glm::dot(c.rb_n, c.angular_b);
+    c.eff_mass = (k > 0.0) ? 1.0 / k : 0.0;
+
+    // colliding contacts bounce back, resting ones just stop approaching
+    const double velocity = relative_velocity(a, b, c);
+    c.target = (velocity < -min_bounce_speed) ? -restitution * velocity : 0.0;
+}
+
+void impulse_solver::warm_start(std::span<Body> bodies, std::span<const Constraint> constraints)
+{
+    for(const auto &c : constraints) {
+        if(c.impulse != 0.0)
+            apply(bodies[c.body_a], bodies[c.body_b], c, c.impulse);
+    }
+}
+
+unsigned impulse_solver::solve(std::span<Body> bodies, std::span<Constraint> constraints,
+                               unsigned iterations, double tolerance)
+{
+    unsigned iteration = 0;
+    while(iteration < iterations) {
+        ++iteration;
+        double residual = 0.0;
+        for(auto &c : constraints)
+            residual = std::max(residual, solve_one(bodies, c));
+        if(residual < tolerance)
+            break;
+    }
+    return iteration;
+}
+
+unsigned impulse_solver::solve_positions(std::span<Body> bodies, std::span<Constraint> constraints,
+                                         unsigned iterations, double tolerance)
+{
+    unsigned iteration = 0;
+    while(iteration < iterations) {
+        ++iteration;
+        double residual = 0.0;
+        for(auto &c : constraints) {
+            if(c.bias <= 0.0 && c.pseudo_impulse == 0.0)
+                continue;
+            Body &a = bodies[c.body_a];
+            Body &b = bodies[c.body_b];
+
+            const double velocity = glm::dot(c.normal, a.pseudo_velocity - b.pseudo_velocity) +
+                                    glm::dot(c.ra_n, a.pseudo_angular_velocity) -
+                                    glm::dot(c.rb_n, b.pseudo_angular_velocity);
+            const double accumulated = std::max(c.pseudo_impulse + c.eff_mass * (c.bias - velocity), 0.0);
+            const double applied = accumulated - c.pseudo_impulse;
+            c.pseudo_impulse = accumulated;
+            if(applied == 0.0)
+                continue;
+
+            a.pseudo_velocity += c.normal * (applied * a.inv_mass);
+            a.pseudo_angular_velocity += c.angular_a * applied;
+            b.pseudo_velocity -= c.normal * (applied * b.inv_mass);
+            b.pseudo_angular_velocity -= c.angular_b * applied;
+            residual = std::max(residual, std::abs(applied) / std::max(c.eff_mass, 1e-12));
+        }
+        if(residual < tolerance)
+            break;
+    }
+    return iteration;
+}
+
+impulse_solver::Coloring impulse_solver::color(std::span<const Constraint> constraints, unsigned body_count)
+{
+    static_assert(SOLVER_MAX_COLORS <= 64, "colors of a body are kept in a 64-bit mask");
+
+    Coloring result;
+    std::vector<std::uint64_t> body_colors(body_count, 0);
+    for(unsigned i = 0; i < constraints.size(); i++) {
+        std::uint64_t &colors_a = body_colors[constraints[i].body_a];
+        std::uint64_t &colors_b = body_colors[constraints[i].body_b];
+
+        // the first color used by neither of the bodies
+        const unsigned color = std::countr_one(colors_a | colors_b);
+        if(color >= SOLVER_MAX_COLORS) {
+            result.rest.push_back(i);
+            continue;
+        }
+        if(color >= result.colors.size())
+            result.colors.resize(color + 1);
+        result.colors[color].push_back(i);
+        colors_a |= std::uint64_t(1) << color;
+        colors_b |= std::uint64_t(1) << color;
+    }
+    return result;
+}
+
+unsigned impulse_solver::solve_colored(std::span<Body> bodies, std::span<Constraint> constraints,
+                                       const Coloring &coloring, ThreadPool &pool,
+                                       unsigned iterations, double tolerance)
+{
+    static_assert(SOLVER_COLOR_CHUNK % SOLVER_LANES == 0, "chunks are made of whole lane groups");
+
+    std::vector<double> residuals;
+    unsigned iteration = 0;
+    while(iteration < iterations) {
+        ++iteration;
+        double residual = 0.0;
+        for(const auto &color : coloring.colors) {
+            // every task writes only to its own constraints, their bodies and its residual
+            const std::size_t tasks = (color.size() + SOLVER_COLOR_CHUNK - 1) / SOLVER_COLOR_CHUNK;
+            residuals.assign(tasks, 0.0);
+            pool.parallel_for(tasks, [&](std::size_t task) {
+                const std::size_t begin = task * SOLVER_COLOR_CHUNK;
+                const std::size_t end = std::min(begin + SOLVER_COLOR_CHUNK, color.size());
+                for(std::size_t i = begin; i < end; i += SOLVER_LANES) {
+                    const unsigned count = std::min<std::size_t>(SOLVER_LANES, end - i);
+                    residuals[task] = std::max(residuals[task], solve_lanes(bodies, constraints, &color[i], count));
+                }
+            });
+            for(const double r : residuals)
+                residual = std::max(residual, r);
+        }
+        for(const unsigned i : coloring.rest)
+            residual = std::max(residual, solve_one(bodies, constraints[i]));
+
+        if(residual < tolerance)
+            break;
+    }
+    return iteration;
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <span>
+#include <vector>
+#include <glm/glm.hpp>
+#include "thread_pool.h"
+
+#define SOLVER_ITERATIONS 10
+#define SOLVER_TOLERANCE  1e-6 // velocity change (m/s) below which iterations stop
+#define SOLVER_LANES 4         // constraints updated at once, doubles in a 256-bit SIMD register
+#define SOLVER_COLOR_CHUNK 64  // constraints of one color per thread pool task (multiple of SOLVER_LANES)
+#define SOLVER_MAX_COLORS 64
+
+// Projected Gauss-Seidel (sequential impulses) contact solver.
+// Works on velocity copies of the bodies, which are written back by the caller;
+// they may live in any contiguous storage (e.g. the frame arena of the scene).
+namespace impulse_solver
+{
+    struct Body {
+        glm::dvec3 velocity;
+        glm::dvec3 angular_velocity;
+        double inv_mass;
+        glm::dmat3x3 inv_inertia; // world space
+
+        // sums of applied impulses, to update momenta of the real body at once
+        glm::dvec3 linear_impulse  = {0.0, 0.0, 0.0};
+        glm::dvec3 angular_impulse = {0.0, 0.0, 0.0};
+
+        // split impulse: velocities that only move the body out of penetration
+        // and are dropped after the step, so no kinetic energy is added
+        glm::dvec3 pseudo_velocity         = {0.0, 0.0, 0.0};
+        glm::dvec3 pseudo_angular_velocity = {0.0, 0.0, 0.0};
+    };
+
+    struct Constraint {
+        unsigned body_a, body_b;
+        glm::dvec3 normal;   // unit, towards body A
+        glm::dvec3 ra, rb;   // contact point relative to centers of mass
+        double eff_mass;     // 1 / (J M^-1 J^T), computed once per frame
+        double target;       // desired relative normal velocity (restitution)
+        double impulse;      // accumulated impulse, warm start value on input
+
+        double bias = 0.0;          // separation speed that removes the penetration
+        double pseudo_impulse = 0.0; // accumulated split impulse
+
+        // parts of J M^-1 J^T, computed in prepare()
+        glm::dvec3 ra_n, rb_n;           // ra x n, rb x n
+        glm::dvec3 angular_a, angular_b; // I^-1 (r x n), angular velocity change per unit impulse
+    };
+
+    // constraints of one color share no bodies, so they can be updated at the
+    // same time; constraints that didn't fit into SOLVER_MAX_COLORS are in rest
+    struct Coloring {
+        std::vector<std::vector<unsigned>> colors;
+        std::vector<unsigned> rest;
+    };
+
+    // fills eff_mass and target of the constraint (bodies must hold pre-solve velocities)
+    void prepare(std::span<const Body> bodies, Constraint &constraint,
+                 double restitution, double min_bounce_speed);
+
+    // applies accumulated impulses from the last frame
+    void warm_start(std::span<Body> bodies, std::span<const Constraint> constraints);
+
+    // returns the number of iterations done
+    unsigned solve(std::span<Body> bodies, std::span<Constraint> constraints,
+                   unsigned iterations = SOLVER_ITERATIONS, double tolerance = SOLVER_TOLERANCE);
+
+    // Gauss-Seidel on the pseudo velocities of the bodies: pushes penetrating
+    // contacts apart with their bias speed (prepare() must be called before)
+    unsigned solve_positions(std::span<Body> bodies, std::span<Constraint> constraints,
+                             unsigned iterations = SOLVER_ITERATIONS, double tolerance = SOLVER_TOLERANCE);
+
+    // greedy coloring of the contact graph, in constraint order
+    Coloring color(std::span<const Constraint> constraints, unsigned body_count);
+
+    // same as solve(), but colors are processed one after another and the
+    // constraints of a color are split between the threads of the pool and
+    // updated SOLVER_LANES at a time; the result doesn't depend on scheduling
+    unsigned solve_colored(std::span<Body> bodies, std::span<Constraint> constraints,
+                           const Coloring &coloring, ThreadPool &pool,
+                           unsigned iterations = SOLVER_ITERATIONS, double tolerance = SOLVER_TOLERANCE);
+}
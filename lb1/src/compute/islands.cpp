@@ -0,0 +1,62 @@
+#include "islands.h"
+#include <numeric>
+
+islands::UnionFind::UnionFind(unsigned size, std::pmr::memory_resource *memory) :
+    _parent(size, memory), _rank(size, 0, memory)
+{
+    std::iota(_parent.begin(), _parent.end(), 0u);
+}
+
+unsigned islands::UnionFind::find(unsigned x)
+{
+    while(_parent[x] != x) {
+        _parent[x] = _parent[_parent[x]];
+        x = _parent[x];
+    }
+    return x;
+}
+
+void islands::UnionFind::unite(unsigned x, unsigned y)
+{
+    x = find(x);
+    y = find(y);
+    if(x == y)
+        return;
+
+    if(_rank[x] < _rank[y])
+        std::swap(x, y);
+    _parent[y] = x;
+    if(_rank[x] == _rank[y])
+        _rank[x]++;
+}
+
+void islands::build(unsigned body_count, std::span<const std::pair<unsigned, unsigned>> edges,
+                    std::vector<Island> &result, std::pmr::memory_resource *memory)
+{
+    UnionFind sets(body_count, memory);
+    for(const auto &edge : edges)
+        sets.unite(edge.first, edge.second);
+
+    // island index of every root, assigned in order of the lowest body
+    std::size_t count = 0;
+    std::pmr::vector<unsigned> island_of_root(body_count, body_count, memory);
+    std::pmr::vector<unsigned> island_of_body(body_count, memory);
+    for(unsigned body = 0; body < body_count; body++) {
+        const unsigned root = sets.find(body);
+        if(island_of_root[root] == body_count) {
+            island_of_root[root] = count++;
+            if(count > result.size()) {
+                result.emplace_back();
+            } else {
+                result[count - 1].bodies.clear();
+                result[count - 1].contacts.clear();
+            }
+        }
+        island_of_body[body] = island_of_root[root];
+        result[island_of_body[body]].bodies.push_back(body);
+    }
+    result.resize(count);
+
+    for(unsigned i = 0; i < edges.size(); i++)
+        result[island_of_body[edges[i].first]].contacts.push_back(i);
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <memory_resource>
+#include <span>
+#include <vector>
+#include <utility>
+
+// Simulation islands: groups of bodies connected by contacts. Bodies of
+// different islands don't interact during a step, so every island can be
+// solved, put to sleep and woken up on its own.
+namespace islands
+{
+    // disjoint set forest with union by rank and path halving
+    class UnionFind
+    {
+    public:
+        explicit UnionFind(unsigned size, std::pmr::memory_resource *memory = std::pmr::get_default_resource());
+
+        unsigned find(unsigned x);
+        void unite(unsigned x, unsigned y);
+
+    private:
+        std::pmr::vector<unsigned> _parent;
+        std::pmr::vector<unsigned> _rank;
+    };
+
+    struct Island {
+        std::vector<unsigned> bodies;   // ascending
+        std::vector<unsigned> contacts; // indices of the edges, ascending
+    };
+
+    // edges[i] are the two bodies of contact i. Every body ends up in exactly
+    // one island, islands are ordered by their lowest body index. Islands
+    // already in result are reused (their lists keep the capacity), the
+    // temporary sets are allocated in memory.
+    void build(unsigned body_count, std::span<const std::pair<unsigned, unsigned>> edges,
+               std::vector<Island> &result, std::pmr::memory_resource *memory = std::pmr::get_default_resource());
+}
@@ -0,0 +1,106 @@
+#include "manifold.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+manifold::Polygon manifold::clip(const Polygon &polygon, const glm::dvec4 &plane, unsigned plane_id)
+{
+    Polygon result;
+    if(polygon.size == 0)
+        return result;
+
+    const glm::dvec3 normal = glm::dvec3(plane.x, plane.y, plane.z);
+    auto plane_dist = [&](const glm::dvec3 &p) { return glm::dot(normal, p) + plane.w; };
+
+    unsigned prev_index = polygon.size - 1;
+    double prev_dist = plane_dist(polygon.points[prev_index]);
+    for(unsigned i = 0; i < polygon.size; i++) {
+        const glm::dvec3 &prev = polygon.points[prev_index];
+        const glm::dvec3 &curr = polygon.points[i];
+        const double curr_dist = plane_dist(curr);
+
+        // edge crosses the plane: add intersection point
+        if((curr_dist <= 0.0) != (prev_dist <= 0.0) && result.size < MAX_POLYGON_POINTS) {
+            const double t = prev_dist / (prev_dist - curr_dist);
+            result.points[result.size] = prev + (curr - prev) * t;
+            result.features[result.size++] = ((plane_id + 1) << 4) | (polygon.features[prev_index] & 0xF);
+        }
+        if(curr_dist <= 0.0 && result.size < MAX_POLYGON_POINTS) {
+            result.points[result.size] = curr;
+            result.features[result.size++] = polygon.features[i];
+        }
+
+        prev_index = i;
+        prev_dist = curr_dist;
+    }
+
+    return result;
+}
+
+unsigned manifold::reduce(const Polygon &polygon, const std::array<double, MAX_POLYGON_POINTS> &depths,
+                          const glm::dvec3 &normal, std::array<unsigned, MAX_MANIFOLD_POINTS> &selected)
+{
+    if(polygon.size <= MAX_MANIFOLD_POINTS) {
+        for(unsigned i = 0; i < polygon.size; i++)
+            selected[i] = i;
+        return polygon.size;
+    }
+
+    const auto &p = polygon.points;
+    // signed area of the triangle projected onto the contact plane (doubled)
+    auto area = [&](unsigned i, unsigned j, unsigned k) {
+        return glm::dot(glm::cross(p[j] - p[i], p[k] - p[i]), normal);
+    };
+
+    // 1. the deepest point
+    unsigned first = 0;
+    for(unsigned i = 1; i < polygon.size; i++) {
+        if(depths[i] > depths[first])
+            first = i;
+    }
+
+    // 2. the farthest point from the first one
+    unsigned second = first;
+    double best = -1.0;
+    for(unsigned i = 0; i < polygon.size; i++) {
+        const glm::dvec3 diff = p[i] - p[first];
+        if(glm::dot(diff, diff) > best) {
+            best = glm::dot(diff, diff);
+            second = i;
+        }
+    }
+
+    // 3. the point giving the largest triangle
+    unsigned third = first;
+    best = -1.0;
+    for(unsigned i = 0; i < polygon.size; i++) {
+        if(std::abs(area(first, second, i)) > best) {
+            best = std::abs(area(first, second, i));
+            third = i;
+        }
+    }
+    const double orientation = (area(first, second, third) >= 0.0) ? 1.0 : -1.0;
+
+    // 4. the point outside of the triangle that adds the most area
+    unsigned fourth = polygon.size;
+    best = 0.0;
+    for(unsigned i = 0; i < polygon.size; i++) {
+        if(i == first || i == second || i == third)
+            continue;
+        const double outside = std::min({area(first, second, i),
+                                         area(second, third, i),
+                                         area(third, first, i)}) * orientation;
+        if(outside < best) {
+            best = outside;
+            fourth = i;
+        }
+    }
+
+    selected[0] = first;
+    selected[1] = second;
+    selected[2] = third;
+    if(fourth == polygon.size)
+        return 3;
+    selected[3] = fourth;
+    return 4;
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <array>
+#include <glm/glm.hpp>
+
+#define MAX_POLYGON_POINTS  8
+#define MAX_MANIFOLD_POINTS 4
+
+// Contact manifold helpers: clipping of the incident face against the side
+// planes of the reference face and reduction of the result to 4 points.
+namespace manifold
+{
+    // convex polygon with fixed capacity: clipping a quad by four planes
+    // gives at most 8 vertices
+    struct Polygon {
+        std::array<glm::dvec3, MAX_POLYGON_POINTS> points;
+        // feature id of every point: initial vertices keep whatever id they were
+        // given, points created by clipping get ((plane_id + 1) << 4) | start vertex id
+        std::array<unsigned, MAX_POLYGON_POINTS> features;
+        unsigned size = 0;
+    };
+
+    // Sutherland-Hodgman: keeps the part of the polygon behind the plane
+    // (dot(normal, p) + w <= 0, planes as returned by Cube::get_faces())
+    Polygon clip(const Polygon &polygon, const glm::dvec4 &plane, unsigned plane_id);
+
+    // Chooses at most 4 points of the polygon: the deepest one and those that
+    // span the largest area in the contact plane. Returns the count of chosen points.
+    unsigned reduce(const Polygon &polygon, const std::array<double, MAX_POLYGON_POINTS> &depths,
+                    const glm::dvec3 &normal, std::array<unsigned, MAX_MANIFOLD_POINTS> &selected);
+}
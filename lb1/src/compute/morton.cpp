@@ -0,0 +1,51 @@
+#include "morton.h"
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+std::uint64_t morton::spread(std::uint32_t x)
+{
+    std::uint64_t v = x & ((1u << MORTON_BITS) - 1);
+    v = (v | (v << 32)) & 0x1f00000000ffffull;
+    v = (v | (v << 16)) & 0x1f0000ff0000ffull;
+    v = (v | (v << 8))  & 0x100f00f00f00f00full;
+    v = (v | (v << 4))  & 0x10c30c30c30c30c3ull;
+    v = (v | (v << 2))  & 0x1249249249249249ull;
+    return v;
+}
+
+std::uint64_t morton::encode(const glm::dvec3 &position, const glm::dvec3 &min, const glm::dvec3 &max)
+{
+    constexpr double cells = double(1u << MORTON_BITS);
+    std::uint64_t code = 0;
+    for(unsigned axis = 0; axis < 3; axis++) {
+        const double extent = max[axis] - min[axis];
+        const double t = (extent > 0.0) ? (position[axis] - min[axis]) / extent : 0.0;
+        const double cell = std::clamp(t * cells, 0.0, cells - 1.0);
+        code |= spread(static_cast<std::uint32_t>(cell)) << axis;
+    }
+    return code;
+}
+
+void morton::sort(std::span<const glm::dvec3> positions, std::span<unsigned> order,
+                  std::pmr::memory_resource *memory)
+{
+    if(positions.empty())
+        return;
+
+    glm::dvec3 min = positions[0], max = positions[0];
+    for(const auto &position : positions) {
+        min = glm::min(min, position);
+        max = glm::max(max, position);
+    }
+
+    std::pmr::vector<std::pair<std::uint64_t, unsigned>> codes(memory);
+    codes.reserve(positions.size());
+    for(unsigned i = 0; i < positions.size(); i++)
+        codes.emplace_back(encode(positions[i], min, max), i);
+    // pairs compare by index after the code, the order is the same as a stable one
+    std::sort(codes.begin(), codes.end());
+
+    for(std::size_t i = 0; i < codes.size(); i++)
+        order[i] = codes[i].second;
+}
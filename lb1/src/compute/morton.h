@@ -0,0 +1,25 @@
+#pragma once
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <glm/glm.hpp>
+
+#define MORTON_BITS 21 // bits of every quantized coordinate, 63 in a code
+
+// Z-order (Morton) codes: the bits of the quantized coordinates are
+// interleaved, so positions close in space mostly get close codes, and
+// objects sorted by their code are stored close to their neighbours.
+namespace morton
+{
+    // moves the lower MORTON_BITS bits of x to every third bit
+    std::uint64_t spread(std::uint32_t x);
+
+    // code of the position quantized in the box [min, max]
+    std::uint64_t encode(const glm::dvec3 &position, const glm::dvec3 &min, const glm::dvec3 &max);
+
+    // order[i] = index of the i-th position along the Z-order curve of their
+    // bounding box, equal codes keep their index order; order must have room
+    // for every position, scratch is taken from memory
+    void sort(std::span<const glm::dvec3> positions, std::span<unsigned> order,
+              std::pmr::memory_resource *memory = std::pmr::get_default_resource());
+}
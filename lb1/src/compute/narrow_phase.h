@@ -0,0 +1,38 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <utility>
+
+// Shape pair dispatch of the narrow phase. Every cell (A, B) of the table is
+// its own instantiation of a collision routine, so pairs are grouped by
+// their shapes first and every group goes to its routine with a single table
+// lookup instead of a virtual call per pair.
+namespace narrow_phase
+{
+    // in the order of the table; pairs are dispatched with the lower shape first
+    enum class Shape : unsigned {
+        BOX,
+        HULL,  // convex polyhedron
+        PLANE, // static
+        COUNT
+    };
+
+    constexpr unsigned SHAPE_COUNT = static_cast<unsigned>(Shape::COUNT);
+    constexpr unsigned CELL_COUNT = SHAPE_COUNT * SHAPE_COUNT;
+
+    constexpr unsigned cell(Shape a, Shape b)
+    {
+        return static_cast<unsigned>(a) * SHAPE_COUNT + static_cast<unsigned>(b);
+    }
+
+    // table[cell(A, B)] = Cell<A, B>::value for every pair of shapes
+    template<typename Entry, template<Shape, Shape> class Cell>
+    constexpr std::array<Entry, CELL_COUNT> make_table()
+    {
+        return []<std::size_t... I>(std::index_sequence<I...>) {
+            return std::array<Entry, CELL_COUNT>{
+                Cell<static_cast<Shape>(I / SHAPE_COUNT), static_cast<Shape>(I % SHAPE_COUNT)>::value...
+            };
+        }(std::make_index_sequence<CELL_COUNT>());
+    }
+}
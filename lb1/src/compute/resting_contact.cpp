@@ -0,0 +1,118 @@
+#include "resting_contact.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // acceleration of the contact point of the body without contact forces
+    glm::dvec3 point_acceleration(const resting_contact::Body &body, const glm::dvec3 &r)
+    {
+        // Euler's equation: dw/dt = I^-1 (torque + L x w)
+        const glm::dvec3 angular_acceleration =
+            body.inv_inertia * (body.torque + glm::cross(body.angular_momentum, body.angular_velocity));
+        return body.force * body.inv_mass +
+               glm::cross(angular_acceleration, r) +
+               glm::cross(body.angular_velocity, glm::cross(body.angular_velocity, r));
+    }
+
+    // relative normal acceleration at contact i (on body k at r_i) produced by
+    // a unit force at contact j (on the same body at r_j)
+    double coupling(const resting_contact::Body &body,
+                    const glm::dvec3 &n_i, const glm::dvec3 &r_i,
+                    const glm::dvec3 &n_j, const glm::dvec3 &r_j)
+    {
+        const glm::dvec3 linear = n_j * body.inv_mass;
+        const glm::dvec3 angular = glm::cross(body.inv_inertia * glm::cross(r_j, n_j), r_i);
+        return glm::dot(n_i, linear + angular);
+    }
+}
+
+unsigned resting_contact::solve(std::span<const Body> bodies, std::span<Constraint> constraints,
+                                std::pmr::memory_resource *memory, unsigned iterations, double tolerance)
+{
+    const std::size_t n = constraints.size();
+    if(n == 0)
+        return 0;
+
+    // contacts touching every body
+    std::pmr::vector<std::pmr::vector<unsigned>> body_contacts(bodies.size(), memory);
+    for(unsigned i = 0; i < n; i++) {
+        body_contacts[constraints[i].body_a].push_back(i);
+        body_contacts[constraints[i].body_b].push_back(i);
+    }
+
+    // b: relative normal acceleration without contact forces
+    std::pmr::vector<double> b(n, memory);
+    for(unsigned i = 0; i < n; i++) {
+        const Constraint &c = constraints[i];
+        const Body &body_a = bodies[c.body_a];
+        const Body &body_b = bodies[c.body_b];
+
+        const glm::dvec3 acc_a = point_acceleration(body_a, c.ra);
+        const glm::dvec3 acc_b = point_acceleration(body_b, c.rb);
+        const glm::dvec3 vel_a = body_a.velocity + glm::cross(body_a.angular_velocity, c.ra);
+        const glm::dvec3 vel_b = body_b.velocity + glm::cross(body_b.angular_velocity, c.rb);
+        // normal is taken as attached to body B, so it rotates with it (exact for
+        // vertex-face contacts where B owns the face)
+        const glm::dvec3 normal_dot = glm::cross(body_b.angular_velocity, c.normal);
+
+        b[i] = glm::dot(c.normal, acc_a - acc_b) + 2.0 * glm::dot(normal_dot, vel_a - vel_b);
+    }
+
+    // A: sparse rows, every row keeps only contacts sharing a body with it
+    std::pmr::vector<std::pmr::vector<std::pair<unsigned, double>>> rows(n, memory);
+    std::pmr::vector<double> diagonal(n, 0.0, memory);
+    for(unsigned i = 0; i < n; i++) {
+        const Constraint &ci = constraints[i];
+        for(const unsigned body : {ci.body_a, ci.body_b}) {
+            const double sign_i = (body == ci.body_a) ? 1.0 : -1.0;
+            const glm::dvec3 &r_i = (body == ci.body_a) ? ci.ra : ci.rb;
+
+            for(const unsigned j : body_contacts[body]) {
+                const Constraint &cj = constraints[j];
+                const double sign_j = (body == cj.body_a) ? 1.0 : -1.0;
+                const glm::dvec3 &r_j = (body == cj.body_a) ? cj.ra : cj.rb;
+                const double value = sign_i * sign_j * coupling(bodies[body], ci.normal, r_i, cj.normal, r_j);
+
+                auto entry = std::find_if(rows[i].begin(), rows[i].end(),
+                                          [j](const auto &e) { return e.first == j; });
+                if(entry == rows[i].end())
+                    rows[i].emplace_back(j, value);
+                else
+                    entry->second += value;
+            }
+        }
+        for(const auto &entry : rows[i]) {
+            if(entry.first == i)
+                diagonal[i] = entry.second;
+        }
+    }
+
+    // projected Gauss-Seidel: f_i = max(0, f_i - a_i / A_ii)
+    std::pmr::vector<double> f(n, memory);
+    for(unsigned i = 0; i < n; i++)
+        f[i] = std::max(constraints[i].force, 0.0);
+
+    unsigned iteration = 0;
+    while(iteration < iterations) {
+        ++iteration;
+        double residual = 0.0;
+        for(unsigned i = 0; i < n; i++) {
+            if(diagonal[i] <= 0.0)
+                continue;
+            double a = b[i];
+            for(const auto &entry : rows[i])
+                a += entry.second * f[entry.first];
+
+            const double updated = std::max(0.0, f[i] - a / diagonal[i]);
+            residual = std::max(residual, std::abs(updated - f[i]) * diagonal[i]);
+            f[i] = updated;
+        }
+        if(residual < tolerance)
+            break;
+    }
+
+    for(unsigned i = 0; i < n; i++)
+        constraints[i].force = f[i];
+    return iteration;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <memory_resource>
+#include <span>
+#include <vector>
+#include <glm/glm.hpp>
+
+#define LCP_ITERATIONS 30
+#define LCP_TOLERANCE  1e-8 // change of relative acceleration below which iterations stop
+
+// Resting contact forces (Baraff, "Rigid Body Simulation", section 8.2).
+// Contact forces f must satisfy the LCP
+//     a = A f + b,  a >= 0,  f >= 0,  f * a = 0
+// where a is the relative normal acceleration at every contact. A is assembled
+// sparsely (contacts only interact through a shared body) and the LCP is solved
+// by projected Gauss-Seidel warm-started with the last frame forces.
+namespace resting_contact
+{
+    struct Body {
+        glm::dvec3 velocity;
+        glm::dvec3 angular_velocity;
+        glm::dvec3 angular_momentum;
+        glm::dvec3 force;  // external force and torque
+        glm::dvec3 torque;
+        double inv_mass;
+        glm::dmat3x3 inv_inertia; // world space
+    };
+
+    struct Constraint {
+        unsigned body_a, body_b;
+        glm::dvec3 normal; // unit, towards body A
+        glm::dvec3 ra, rb; // contact point relative to centers of mass
+        double force;      // contact force, warm start value on input
+    };
+
+    // returns the number of iterations done; the matrix is assembled in memory
+    unsigned solve(std::span<const Body> bodies, std::span<Constraint> constraints,
+                   std::pmr::memory_resource *memory = std::pmr::get_default_resource(),
+                   unsigned iterations = LCP_ITERATIONS, double tolerance = LCP_TOLERANCE);
+}
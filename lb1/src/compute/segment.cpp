@@ -0,0 +1,70 @@
+#include "segment.h"
+#include <algorithm>
+
+namespace
+{
+    // parameters of the closest points from the dot products of the directions
+    // d0, d1 and of r = start_a - start_b:
+    // a = d0 d0, b = d0 d1, c = d0 r, e = d1 d1, f = d1 r.
+    // Degenerate segments and parallel ones are handled without branching:
+    // s starts at 0 for parallel lines and every division is guarded.
+    inline void parameters(double a, double b, double c, double e, double f, double &s, double &t)
+    {
+        const double denom = a * e - b * b;
+        a = std::max(a, SEGMENT_EPSILON);
+        e = std::max(e, SEGMENT_EPSILON);
+
+        // closest point of the lines, clamped to the first segment
+        s = (denom > SEGMENT_EPSILON * a * e) ? std::clamp((b * f - c * e) / denom, 0.0, 1.0) : 0.0;
+        // the point of the second segment closest to it
+        t = std::clamp((b * s + f) / e, 0.0, 1.0);
+        // if t got clamped, s has to follow it; otherwise this gives s back
+        s = std::clamp((b * t - c) / a, 0.0, 1.0);
+    }
+}
+
+segment::ClosestPoints segment::closest_points(const glm::dvec3 &p0, const glm::dvec3 &q0,
+                                               const glm::dvec3 &p1, const glm::dvec3 &q1)
+{
+    const glm::dvec3 d0 = q0 - p0;
+    const glm::dvec3 d1 = q1 - p1;
+    const glm::dvec3 r = p0 - p1;
+
+    ClosestPoints result;
+    parameters(glm::dot(d0, d0), glm::dot(d0, d1), glm::dot(d0, r), glm::dot(d1, d1), glm::dot(d1, r),
+               result.s, result.t);
+    result.point_a = p0 + d0 * result.s;
+    result.point_b = p1 + d1 * result.t;
+    const glm::dvec3 diff = result.point_a - result.point_b;
+    result.distance2 = glm::dot(diff, diff);
+    return result;
+}
+
+void segment::closest_points(Batch &batch)
+{
+    constexpr unsigned L = SEGMENT_LANES;
+    double a[L] = {}, b[L] = {}, c[L] = {}, e[L] = {}, f[L] = {};
+    for(unsigned k = 0; k < 3; k++) {
+        for(unsigned l = 0; l < L; l++) {
+            const double r = batch.start_a[k][l] - batch.start_b[k][l];
+            a[l] += batch.dir_a[k][l] * batch.dir_a[k][l];
+            b[l] += batch.dir_a[k][l] * batch.dir_b[k][l];
+            c[l] += batch.dir_a[k][l] * r;
+            e[l] += batch.dir_b[k][l] * batch.dir_b[k][l];
+            f[l] += batch.dir_b[k][l] * r;
+        }
+    }
+
+    for(unsigned l = 0; l < L; l++)
+        parameters(a[l], b[l], c[l], e[l], f[l], batch.s[l], batch.t[l]);
+
+    double distance2[L] = {};
+    for(unsigned k = 0; k < 3; k++) {
+        for(unsigned l = 0; l < L; l++) {
+            const double diff = (batch.start_a[k][l] + batch.dir_a[k][l] * batch.s[l]) -
+                                (batch.start_b[k][l] + batch.dir_b[k][l] * batch.t[l]);
+            distance2[l] += diff * diff;
+        }
+    }
+    std::copy(distance2, distance2 + L, batch.distance2);
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <glm/glm.hpp>
+
+#define SEGMENT_LANES 4
+#define SEGMENT_EPSILON 1e-12
+
+// Closest points between two segments, closed form (Ericson, Real-Time
+// Collision Detection, 5.1.9): the parameters of the infinite lines are
+// clamped to the segments, so there is no matrix to eliminate.
+namespace segment
+{
+    struct ClosestPoints {
+        double s = 0.0, t = 0.0;     // parameters along the first and second segment, in [0, 1]
+        glm::dvec3 point_a, point_b; // p0 + s (q0 - p0), p1 + t (q1 - p1)
+        double distance2 = 0.0;      // squared distance between the points
+    };
+
+    // segments p0-q0 and p1-q1
+    ClosestPoints closest_points(const glm::dvec3 &p0, const glm::dvec3 &q0,
+                                 const glm::dvec3 &p1, const glm::dvec3 &q1);
+
+    // SEGMENT_LANES pairs of segments laid out as arrays of lanes, so the
+    // same computation as above compiles to SIMD instructions.
+    // Segments are given by a start point and a direction (end - start).
+    struct Batch {
+        double start_a[3][SEGMENT_LANES], dir_a[3][SEGMENT_LANES];
+        double start_b[3][SEGMENT_LANES], dir_b[3][SEGMENT_LANES];
+        // results
+        double s[SEGMENT_LANES], t[SEGMENT_LANES], distance2[SEGMENT_LANES];
+    };
+
+    // fills s, t and distance2 of every lane
+    void closest_points(Batch &batch);
+}
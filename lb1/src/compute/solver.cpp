@@ -1,5 +1,6 @@
 #include "solver.h"
 #include <cmath>
+#include <limits>
 
 template<solver::HasSolvingMethods T>
 void solver::euler_solver(T &object, double t_to_sim, double step)
@@ -112,6 +113,114 @@ void solver::rk5_solver(T &object, double t_to_sim)
     object.update_from_array(initial_state);
 }
 
+template<solver::HasSolvingMethods T>
+double solver::solve_with_events(std::span<T* const> objects, double t_to_sim,
+                                 const std::function<void(T&, double)> &method,
+                                 const std::vector<EventFunction> &events,
+                                 double tolerance)
+{
+    if(events.empty()) {
+        for(T *object : objects)
+            method(*object, t_to_sim);
+        return t_to_sim;
+    }
+
+    std::vector<std::array<double, 13>> initial_states;
+    initial_states.reserve(objects.size());
+    for(T *object : objects)
+        initial_states.push_back(object->state_as_array());
+
+    // state of every object at time t from the beginning of the step
+    auto integrate_to = [&](double t) {
+        for(std::size_t i = 0; i < objects.size(); i++) {
+            objects[i]->update_from_array(initial_states[i]);
+            if(t > 0.0)
+                method(*objects[i], t);
+        }
+    };
+
+    std::vector<double> initial_values;
+    initial_values.reserve(events.size());
+    for(const auto &event : events)
+        initial_values.push_back(event());
+
+    // the step is sampled at EVENT_SAMPLES points, the first sub-interval at
+    // the end of which some event is negative brackets the first event
+    std::vector<double> begin_values = initial_values;
+    std::vector<double> end_values(events.size());
+    std::vector<std::size_t> happened;
+    double t_begin = 0.0, t_end = 0.0;
+    double fa = std::numeric_limits<double>::max();
+    double fb = std::numeric_limits<double>::max();
+    for(unsigned k = 1; k <= EVENT_SAMPLES && happened.empty(); k++) {
+        if(k > 1) {
+            t_begin = t_end;
+            std::swap(begin_values, end_values);
+        }
+        t_end = k == EVENT_SAMPLES ? t_to_sim : t_to_sim * k / EVENT_SAMPLES;
+        integrate_to(t_end);
+        for(std::size_t i = 0; i < events.size(); i++) {
+            // negative from the start: the pair is in contact already
+            if(initial_values[i] < 0.0)
+                continue;
+            end_values[i] = events[i]();
+            if(end_values[i] < 0.0) {
+                happened.push_back(i);
+                fa = std::min(fa, begin_values[i]);
+                fb = std::min(fb, end_values[i]);
+            }
+        }
+    }
+    if(happened.empty())
+        return t_to_sim;
+
+    // the first of them is the first root of their minimum
+    auto first_event = [&](double t) {
+        integrate_to(t);
+        double value = std::numeric_limits<double>::max();
+        for(const std::size_t i : happened)
+            value = std::min(value, events[i]());
+        return value;
+    };
+    const double t_event = solver::find_root(first_event, t_begin, t_end, fa, fb, tolerance);
+    integrate_to(t_event);
+    return t_event;
+}
+
+double solver::find_root(const std::function<double(double)> &f, double a, double b, double fa, double fb,
+                         double tolerance, unsigned max_iterations)
+{
+    // -1 / +1 side of the last chord point, for the Illinois modification
+    int side = 0;
+    for(unsigned i = 0; i < max_iterations && std::abs(b - a) > tolerance; i++) {
+        // Linear interpolation between (a, fa) and (b, fb)
+        double c = (a * fb - b * fa) / (fb - fa);
+        // rounding put the chord point outside of the bracket: bisect instead
+        if(!std::isfinite(c) || !(std::min(a, b) < c && c < std::max(a, b)))
+            c = (a + b) * 0.5;
+
+        const double fc = f(c);
+        if(fc == 0.0)
+            return c;
+
+        if((fc < 0.0) == (fa < 0.0)) {
+            a = c;
+            fa = fc;
+            // a moved twice in a row: halve the value at the other end
+            if(side == -1)
+                fb *= 0.5;
+            side = -1;
+        } else {
+            b = c;
+            fb = fc;
+            if(side == 1)
+                fa *= 0.5;
+            side = 1;
+        }
+    }
+    return a;
+}
+
 template<std::size_t N>
 void solver::sum_arrays(std::array<double, N> &dest, const std::array<double, N> &src)
 {
@@ -146,52 +255,13 @@ bool solver::check_value_equal(double v1, double v2, double epsilon)
     return abs(res) <= epsilon;
 }
 
-void solver::reduce_to_RREF(glm::dmat3x4 &matrix) {
-    int lead = 0;
-    int rowCount = matrix.length();
-    int colCount = matrix[0].length();
-
-    for (int r = 0; r < rowCount; r++) {
-        if (lead >= colCount) break;
-
-        int i = r;
-        while (matrix[i][lead] == 0) {
-            i++;
-            if (i == rowCount) {
-                i = r;
-                lead++;
-                if (lead == colCount) return;
-            }
-        }
-
-        if (i != r) {
-            for (int k = 0; k < colCount; k++) {
-                std::swap(matrix[i][k], matrix[r][k]);
-            }
-        }
-
-        float val = matrix[r][lead];
-        for (int k = 0; k < colCount; k++) {
-            matrix[r][k] /= val;
-        }
-
-        for (int i = 0; i < rowCount; i++) {
-            if (i != r) {
-                float factor = matrix[i][lead];
-                for (int k = 0; k < colCount; k++) {
-                    matrix[i][k] -= factor * matrix[r][k];
-                }
-            }
-        }
-
-        lead++;
-    }
-}
-
 // Explicit instantiation to compile function templates
 #include "../model/cube.h"
 template void solver::euler_solver<Cube>(Cube&, double, double);
 template void solver::rk4_solver<Cube>(Cube&, double);
 template void solver::rk5_solver<Cube>(Cube&, double);
+template double solver::solve_with_events<Cube>(std::span<Cube* const>, double,
+                                                const std::function<void(Cube&, double)>&,
+                                                const std::vector<solver::EventFunction>&, double);
 template void solver::sum_arrays<13>(std::array<double, 13>&, const std::array<double, 13>&);
 template void solver::mul_array<13>(std::array<double, 13>&, double);
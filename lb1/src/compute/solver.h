@@ -1,8 +1,15 @@
 #pragma once
 #include <stdlib.h>
 #include <array>
+#include <functional>
+#include <span>
+#include <vector>
 #include <glm/mat3x4.hpp>
 
+#define ROOT_MAX_ITERATIONS   50
+#define EVENT_TIME_TOLERANCE  1e-5 // seconds
+#define EVENT_SAMPLES         4    // sub-intervals of a step searched for the first event
+
 namespace solver
 {
     template<typename T>
@@ -21,6 +28,33 @@ namespace solver
     template<HasSolvingMethods T>
     void rk5_solver(T &object, double t_to_sim);
 
+    // Event function: signed value computed from the current state of the
+    // objects (e.g. separation of a pair of bodies). An event happens when it
+    // goes from >= 0 to < 0.
+    using EventFunction = std::function<double()>;
+
+    // Integrates every object over t_to_sim with method (one of the solvers
+    // above). If some events happen during the step, the objects are rolled
+    // back and integrated only up to the first one, located by find_root().
+    // Returns the time actually simulated.
+    // Events are looked for at the ends of EVENT_SAMPLES equal sub-intervals,
+    // the root is refined in the first one where an event is negative. An
+    // event that goes negative and recovers within one sub-interval is missed,
+    // and with several roots in that sub-interval any of them may be found.
+    template<HasSolvingMethods T>
+    double solve_with_events(std::span<T* const> objects, double t_to_sim,
+                             const std::function<void(T&, double)> &method,
+                             const std::vector<EventFunction> &events,
+                             double tolerance = EVENT_TIME_TOLERANCE);
+
+    // Root of f in [a, b], f(a) and f(b) must have opposite signs (fa, fb).
+    // Chord method keeping the bracket, with the Illinois modification against
+    // a stuck end, bisection if a chord point falls out of the bracket.
+    // Returns the end of the final bracket on the side of a, at most tolerance
+    // away from the root.
+    double find_root(const std::function<double(double)> &f, double a, double b, double fa, double fb,
+                     double tolerance, unsigned max_iterations = ROOT_MAX_ITERATIONS);
+
     template<std::size_t N>
     void sum_arrays(std::array<double, N> &dest, const std::array<double, N> &src);
     
@@ -30,6 +64,4 @@ namespace solver
     bool check_value_greater(double v1, double v2, double epsilon);
     bool check_value_less(double v1, double v2, double epsilon);
     bool check_value_equal(double v1, double v2, double epsilon);
-
-    void reduce_to_RREF(glm::dmat3x4& matrix);
 }
@@ -0,0 +1,95 @@
+#include "thread_pool.h"
+
+ThreadPool::ThreadPool(unsigned threads)
+{
+    if(threads == 0) {
+        const unsigned hardware = std::thread::hardware_concurrency();
+        threads = (hardware > 1) ? hardware - 1 : 0;
+    }
+    _workers.reserve(threads);
+    for(unsigned i = 0; i < threads; i++)
+        _workers.emplace_back(&ThreadPool::_worker_loop, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _work_cv.notify_all();
+    for(auto &worker : _workers)
+        worker.join();
+}
+
+unsigned ThreadPool::size() const
+{
+    return _workers.size() + 1;
+}
+
+void ThreadPool::parallel_for(std::size_t count, const std::function<void(std::size_t)> &task)
+{
+    // not worth waking anybody up
+    if(count <= 1 || _workers.empty()) {
+        for(std::size_t i = 0; i < count; i++)
+            task(i);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _task = &task;
+        _count = count;
+        _finished = 0;
+        _next = 0;
+        _generation++;
+    }
+    _work_cv.notify_all();
+
+    const std::size_t done = _run_tasks(task, count);
+
+    // the loop is over when all tasks are done and no worker still looks at it
+    std::unique_lock<std::mutex> lock(_mutex);
+    _finished += done;
+    _done_cv.wait(lock, [this] { return _finished == _count && _active == 0; });
+    _task = nullptr;
+    _count = 0;
+}
+
+void ThreadPool::_worker_loop()
+{
+    std::uint64_t generation = 0;
+    while(true) {
+        const std::function<void(std::size_t)> *task;
+        std::size_t count;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _work_cv.wait(lock, [&] { return _stop || (_task != nullptr && _generation != generation); });
+            if(_stop)
+                return;
+            generation = _generation;
+            task = _task;
+            count = _count;
+            _active++;
+        }
+
+        const std::size_t done = _run_tasks(*task, count);
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _finished += done;
+            _active--;
+        }
+        _done_cv.notify_one();
+    }
+}
+
+std::size_t ThreadPool::_run_tasks(const std::function<void(std::size_t)> &task, std::size_t count)
+{
+    std::size_t done = 0;
+    for(std::size_t i = _next.fetch_add(1); i < count; i = _next.fetch_add(1)) {
+        task(i);
+        done++;
+    }
+    return done;
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define WORKER_THREADS 0 // 0 = hardware concurrency - 1 (the calling thread works too)
+
+// Fixed set of worker threads running parallel loops. Tasks of a loop are
+// taken in index order from a shared counter, the calling thread takes part
+// and returns when every task is done. One loop runs at a time.
+class ThreadPool
+{
+public:
+    explicit ThreadPool(unsigned threads = WORKER_THREADS);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // number of threads running tasks, including the caller
+    unsigned size() const;
+
+    // runs task(0) ... task(count - 1), in any order and on any thread
+    void parallel_for(std::size_t count, const std::function<void(std::size_t)> &task);
+
+private:
+    void _worker_loop();
+    // takes tasks of the current loop until none is left, returns how many were run
+    std::size_t _run_tasks(const std::function<void(std::size_t)> &task, std::size_t count);
+
+    std::vector<std::thread> _workers;
+
+    std::mutex _mutex;
+    std::condition_variable _work_cv;
+    std::condition_variable _done_cv;
+
+    // current loop, guarded by _mutex (except the counter)
+    const std::function<void(std::size_t)> *_task = nullptr;
+    std::size_t _count = 0;
+    std::size_t _finished = 0;
+    unsigned _active = 0; // workers that joined the current loop
+    std::uint64_t _generation = 0;
+    bool _stop = false;
+    std::atomic<std::size_t> _next{0};
+};
@@ -0,0 +1,26 @@
+#include "triple_buffer.h"
+#include "../view/renderer.h"
+
+template<typename T>
+T &TripleBuffer<T>::back()
+{
+    return _copies[_back];
+}
+
+template<typename T>
+void TripleBuffer<T>::publish()
+{
+    // release: the reader sees the filled copy, acquire: the copy taken in
+    // exchange is one the reader is done with
+    _back = _middle.exchange(_back | FRESH, std::memory_order_acq_rel) & INDEX;
+}
+
+template<typename T>
+const T &TripleBuffer<T>::front()
+{
+    if(_middle.load(std::memory_order_relaxed) & FRESH)
+        _front = _middle.exchange(_front, std::memory_order_acq_rel) & INDEX;
+    return _copies[_front];
+}
+
+template class TripleBuffer<RenderFrame>;
@@ -0,0 +1,37 @@
+#pragma once
+#include <array>
+#include <atomic>
+
+// Three copies of a value passed from one writer thread to one reader
+// thread without locks. The writer fills back() and publishes it, the reader
+// takes the latest published copy with front(). Each side owns one copy and
+// the third is swapped between them with a single atomic exchange, so
+// neither side ever waits for the other; copies the reader is too slow to
+// see are overwritten.
+template<typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() = default;
+
+    TripleBuffer(const TripleBuffer &) = delete;
+    TripleBuffer &operator=(const TripleBuffer &) = delete;
+
+    // copy the writer fills, not seen by the reader until publish()
+    T &back();
+    // makes back() the latest copy, back() is another copy afterwards
+    void publish();
+
+    // latest published copy (the initial value before any), stays unchanged
+    // until the next call
+    const T &front();
+
+private:
+    static constexpr unsigned INDEX = 3u;
+    static constexpr unsigned FRESH = 4u; // published, the reader hasn't taken it yet
+
+    std::array<T, 3> _copies;
+    unsigned _back = 0;               // writer only
+    std::atomic<unsigned> _middle{1}; // index | FRESH
+    unsigned _front = 2;              // reader only
+};
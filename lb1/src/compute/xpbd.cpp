@@ -0,0 +1,150 @@
+#include "xpbd.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    glm::dmat3x3 world_inv_inertia(const xpbd::Body &body)
+    {
+        const glm::dmat3x3 rotation = glm::mat3_cast(body.orientation);
+        return rotation * body.inv_inertia_body * glm::transpose(rotation);
+    }
+
+    // inverse mass of the body seen along direction n at arm r
+    double generalized_inv_mass(const xpbd::Body &body, const glm::dvec3 &r, const glm::dvec3 &n)
+    {
+        const glm::dvec3 r_n = glm::cross(r, n);
+        return body.inv_mass + glm::dot(r_n, world_inv_inertia(body) * r_n);
+    }
+
+    // positional impulse p at arm r: moves and rotates the body
+    void apply_correction(xpbd::Body &body, const glm::dvec3 &r, const glm::dvec3 &p)
+    {
+        if(body.inv_mass == 0.0)
+            return;
+        body.position += p * body.inv_mass;
+        const glm::dvec3 rotation = world_inv_inertia(body) * glm::cross(r, p);
+        body.orientation += 0.5 * (glm::dquat(0.0, rotation) * body.orientation);
+        body.orientation = glm::normalize(body.orientation);
+    }
+
+    // velocity impulse p at arm r
+    void apply_impulse(xpbd::Body &body, const glm::dvec3 &r, const glm::dvec3 &p)
+    {
+        if(body.inv_mass == 0.0)
+            return;
+        body.velocity += p * body.inv_mass;
+        body.angular_velocity += world_inv_inertia(body) * glm::cross(r, p);
+    }
+}
+
+xpbd::Contact xpbd::make_contact(std::span<const Body> bodies, unsigned body_a, unsigned body_b,
+                                 const glm::dvec3 &point_a, const glm::dvec3 &point_b, const glm::dvec3 &normal)
+{
+    const Body &a = bodies[body_a];
+    const Body &b = bodies[body_b];
+    Contact contact;
+    contact.body_a = body_a;
+    contact.body_b = body_b;
+    contact.anchor_a = glm::transpose(glm::mat3_cast(a.orientation)) * (point_a - a.position);
+    contact.anchor_b = glm::transpose(glm::mat3_cast(b.orientation)) * (point_b - b.position);
+    contact.normal = normal;
+    return contact;
+}
+
+void xpbd::integrate(Body &body, double h)
+{
+    body.prev_position = body.position;
+    body.prev_orientation = body.orientation;
+    if(body.inv_mass == 0.0)
+        return;
+
+    body.velocity += body.force * (body.inv_mass * h);
+    body.position += body.velocity * h;
+
+    // Euler's equation in world space: dw/dt = I^-1 (torque - w x (I w))
+    const glm::dmat3x3 rotation = glm::mat3_cast(body.orientation);
+    const glm::dmat3x3 inertia = rotation * glm::inverse(body.inv_inertia_body) * glm::transpose(rotation);
+    const glm::dmat3x3 inv_inertia = rotation * body.inv_inertia_body * glm::transpose(rotation);
+    const glm::dvec3 gyroscopic = glm::cross(body.angular_velocity, inertia * body.angular_velocity);
+    body.angular_velocity += inv_inertia * (body.torque - gyroscopic) * h;
+
+    body.orientation += 0.5 * h * (glm::dquat(0.0, body.angular_velocity) * body.orientation);
+    body.orientation = glm::normalize(body.orientation);
+}
+
+void xpbd::solve_positions(std::span<Body> bodies, std::span<Contact> contacts, double h)
+{
+    for(auto &contact : contacts) {
+        Body &a = bodies[contact.body_a];
+        Body &b = bodies[contact.body_b];
+        const glm::dvec3 ra = glm::mat3_cast(a.orientation) * contact.anchor_a;
+        const glm::dvec3 rb = glm::mat3_cast(b.orientation) * contact.anchor_b;
+
+        // signed separation of the anchors along the normal
+        const double separation = glm::dot((a.position + ra) - (b.position + rb), contact.normal);
+        contact.active = separation < 0.0;
+        if(!contact.active)
+            continue;
+
+        const double w = generalized_inv_mass(a, ra, contact.normal) + generalized_inv_mass(b, rb, contact.normal);
+        const double alpha = contact.compliance / (h * h);
+        if(w + alpha <= 0.0)
+            continue;
+
+        // one iteration per substep: lambda starts from zero every time
+        const double delta_lambda = -separation / (w + alpha);
+        const glm::dvec3 p = contact.normal * delta_lambda;
+        apply_correction(a, ra, p);
+        apply_correction(b, rb, -p);
+    }
+}
+
+void xpbd::update_velocities(Body &body, double h)
+{
+    if(body.inv_mass == 0.0)
+        return;
+    body.velocity = (body.position - body.prev_position) / h;
+
+    const glm::dquat delta = body.orientation * glm::conjugate(body.prev_orientation);
+    body.angular_velocity = glm::dvec3(delta.x, delta.y, delta.z) * (2.0 / h);
+    if(delta.w < 0.0)
+        body.angular_velocity = -body.angular_velocity;
+}
+
+void xpbd::solve_velocities(std::span<Body> bodies, std::span<Contact> contacts,
+                            double restitution, double min_bounce_speed)
+{
+    for(const auto &contact : contacts) {
+        if(!contact.active)
+            continue;
+        Body &a = bodies[contact.body_a];
+        Body &b = bodies[contact.body_b];
+        const glm::dvec3 ra = glm::mat3_cast(a.orientation) * contact.anchor_a;
+        const glm::dvec3 rb = glm::mat3_cast(b.orientation) * contact.anchor_b;
+
+        // slow impacts don't bounce, that would keep resting bodies jittering
+        const double velocity = normal_velocity(bodies, contact);
+        const double bounce = (contact.normal_velocity < -min_bounce_speed) ?
+                              -restitution * contact.normal_velocity : 0.0;
+        const double delta_velocity = bounce - velocity;
+
+        const double w = generalized_inv_mass(a, ra, contact.normal) + generalized_inv_mass(b, rb, contact.normal);
+        if(w <= 0.0)
+            continue;
+        const glm::dvec3 p = contact.normal * (delta_velocity / w);
+        apply_impulse(a, ra, p);
+        apply_impulse(b, rb, -p);
+    }
+}
+
+double xpbd::normal_velocity(std::span<const Body> bodies, const Contact &contact)
+{
+    const Body &a = bodies[contact.body_a];
+    const Body &b = bodies[contact.body_b];
+    const glm::dvec3 ra = glm::mat3_cast(a.orientation) * contact.anchor_a;
+    const glm::dvec3 rb = glm::mat3_cast(b.orientation) * contact.anchor_b;
+    const glm::dvec3 va = a.velocity + glm::cross(a.angular_velocity, ra);
+    const glm::dvec3 vb = b.velocity + glm::cross(b.angular_velocity, rb);
+    return glm::dot(contact.normal, va - vb);
+}
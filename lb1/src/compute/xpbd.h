@@ -0,0 +1,61 @@
+#pragma once
+#include <span>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#define XPBD_SUBSTEPS 20 // per frame, one position iteration each
+#define XPBD_CONTACT_COMPLIANCE 0.0 // m/N, 0 = rigid contacts
+
+// Extended position based dynamics for rigid bodies (Mueller et al.,
+// "Detailed Rigid Body Simulation with Extended Position Based Dynamics").
+// The frame is split into small substeps, every substep predicts the poses,
+// projects contact constraints on positions once, derives velocities from
+// the pose change and applies restitution on the velocity level.
+namespace xpbd
+{
+    struct Body {
+        glm::dvec3 position;
+        glm::dquat orientation;
+        glm::dvec3 velocity;
+        glm::dvec3 angular_velocity;
+        glm::dvec3 force;  // external force and torque
+        glm::dvec3 torque;
+        double inv_mass;
+        glm::dmat3x3 inv_inertia_body; // body space
+
+        // pose at the beginning of the substep
+        glm::dvec3 prev_position{};
+        glm::dquat prev_orientation{1.0, 0.0, 0.0, 0.0};
+    };
+
+    struct Contact {
+        unsigned body_a, body_b;
+        glm::dvec3 anchor_a, anchor_b; // contact point on each body, body space
+        glm::dvec3 normal;             // unit, towards body A, fixed for the frame
+        double compliance = XPBD_CONTACT_COMPLIANCE;
+
+        // filled during a substep
+        double normal_velocity = 0.0; // relative normal velocity before the substep
+        bool active = false;          // position constraint was applied this substep
+    };
+
+    // anchors of a contact from a world point on each body
+    Contact make_contact(std::span<const Body> bodies, unsigned body_a, unsigned body_b,
+                         const glm::dvec3 &point_a, const glm::dvec3 &point_b, const glm::dvec3 &normal);
+
+    // saves the pose and moves the body by its velocities (explicit, with gyroscopic term)
+    void integrate(Body &body, double h);
+
+    // one projection of every contact, keeps bodies from penetrating
+    void solve_positions(std::span<Body> bodies, std::span<Contact> contacts, double h);
+
+    // velocities from the pose change of the substep
+    void update_velocities(Body &body, double h);
+
+    // restitution for the contacts that were active in the substep
+    void solve_velocities(std::span<Body> bodies, std::span<Contact> contacts,
+                          double restitution, double min_bounce_speed);
+
+    // relative normal velocity of the contact points (positive = separating)
+    double normal_velocity(std::span<const Body> bodies, const Contact &contact);
+}
@@ -6,6 +6,7 @@
 #include <chrono>
 #include <thread>
 #include <functional>
+#include <utility>
 
 App::App(std::size_t window_width, std::size_t window_height) :
     _win_width{window_width}, _win_height{window_height}
@@ -43,7 +44,7 @@ void App::_setup_glfw()
 void App::_handle_input()
 {
     if (glfwGetKey(_window, GLFW_KEY_SPACE) == GLFW_PRESS) {
-        _scene->apply_action();
+        _action_requested = true;
     }
 
     
@@ -53,7 +54,8 @@ void App::_handle_input()
         glfwGetCursorPos(_window, &mouse_x, &mouse_y);
 
         if(glfwGetMouseButton(_window, GLFW_MOUSE_BUTTON_LEFT)) {
-            _scene->rotate_camera(prev_mouse_x - mouse_x, prev_mouse_y - mouse_y);
+            _camera_angle_x.fetch_add(prev_mouse_x - mouse_x);
+            _camera_angle_y.fetch_add(prev_mouse_y - mouse_y);
         }
         prev_mouse_x = mouse_x;
         prev_mouse_y = mouse_y;
@@ -62,15 +64,66 @@ void App::_handle_input()
 
 void App::run()
 {
-    std::chrono::steady_clock::time_point timestamp = std::chrono::steady_clock::now();
+    // the first frame is there before the simulation starts
+    Renderer::capture(*_scene, _frames.back());
+    _frames.publish();
+
+    // the scene is only touched by the simulation thread from now on, this
+    // one draws the latest frame it published, both at their own rate
+    _running = true;
+    _simulation = std::thread(&App::_simulate, this);
     while(!glfwWindowShouldClose(_window)) {
         glfwPollEvents();
         _handle_input();
-        
+        _renderer->render(_frames.front());
+    }
+    _running = false;
+    _simulation.join();
+}
+
+void App::_simulate()
+{
+    const std::chrono::steady_clock::duration period = std::chrono::microseconds(1000000 / SIMULATION_RATE);
+    std::chrono::steady_clock::time_point timestamp = std::chrono::steady_clock::now();
+    while(_running) {
+        if(_action_requested.exchange(false))
+            _scene->apply_action();
+        const float angle_x = _camera_angle_x.exchange(0.0f);
+        const float angle_y = _camera_angle_y.exchange(0.0f);
+        if(angle_x != 0.0f || angle_y != 0.0f)
+            _scene->rotate_camera(angle_x, angle_y);
+
         std::chrono::steady_clock::time_point timestamp_new = std::chrono::steady_clock::now();
         float seconds_on_frame = std::chrono::duration_cast<std::chrono::microseconds>(timestamp_new - timestamp).count() / 1000000.0f;
         _scene->update(seconds_on_frame/2);
-        _renderer->render(*_scene);
         timestamp = timestamp_new;
+
+        Renderer::capture(*_scene, _frames.back());
+        _frames.publish();
+
+        std::this_thread::sleep_until(timestamp + period);
+    }
+}
+
+void App::benchmark(unsigned frames)
+{
+    const float dt = 1.0f / 60.0f;
+    const std::pair<PhysicsBackend, const char *> backends[] = {
+        {PhysicsBackend::IMPULSE, "impulse"},
+        {PhysicsBackend::XPBD,    "xpbd"}
+    };
+
+    for(const auto &[backend, name] : backends) {
+        Scene scene(backend);
+        scene.apply_action();
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for(unsigned i = 0; i < frames; i++)
+            scene.update(dt);
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+        const double ms = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000.0;
+        std::cout << name << ": " << ms / frames << " ms/frame, kinetic energy after "
+                  << frames << " frames: " << scene.get_kinetic_energy() << std::endl;
     }
 }
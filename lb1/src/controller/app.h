@@ -1,10 +1,15 @@
 #pragma once
 
+#include <atomic>
 #include <cstddef>
+#include <thread>
 
 #include <GLFW/glfw3.h>
 #include "../model/scene.h"
 #include "../view/renderer.h"
+#include "../compute/triple_buffer.h"
+
+#define SIMULATION_RATE 240 // max updates per second of the scene on the simulation thread
 
 class App
 {
@@ -12,13 +17,28 @@ public:
     App(std::size_t window_width, std::size_t window_height);
     ~App();
     void run();
+    // runs the same scene headless with every physics backend and prints
+    // the time per frame and the final kinetic energy of each
+    static void benchmark(unsigned frames);
 private:
     void _setup_glfw();
     void _handle_input();
+    // body of the simulation thread: applies the input, steps the scene and
+    // publishes what is drawn until _running is cleared
+    void _simulate();
 
     std::size_t _win_width, _win_height;
     GLFWwindow *_window;
 
     Scene    *_scene;
     Renderer *_renderer;
+
+    std::thread _simulation;
+    std::atomic<bool> _running{false};
+    // written by the simulation thread, drawn by the main thread
+    TripleBuffer<RenderFrame> _frames;
+
+    // input read on the main thread, not applied to the scene yet
+    std::atomic<bool>  _action_requested{false};
+    std::atomic<float> _camera_angle_x{0.0f}, _camera_angle_y{0.0f};
 };
@@ -1,7 +1,16 @@
 #include "controller/app.h"
 
-int main()
+#include <cstdlib>
+#include <string>
+
+int main(int argc, char **argv)
 {
+    // --benchmark [frames]: compare the physics backends without opening a window
+    if(argc > 1 && std::string(argv[1]) == "--benchmark") {
+        App::benchmark(argc > 2 ? std::atoi(argv[2]) : 600);
+        return 0;
+    }
+
     App app(1920, 1080);
     app.run();
 
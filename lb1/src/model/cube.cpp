@@ -3,6 +3,31 @@
 #include <glm/gtx/norm.hpp>
 #include "cube.h"
 #include "../compute/solver.h"
+#include <atomic>
+
+namespace
+{
+    // bounding box of the hull around its center of mass
+    glm::dvec3 hull_size(const hull::Hull &hull)
+    {
+        glm::dvec3 extent(0.0);
+        for(const auto &vertex : hull.vertices())
+            extent = glm::max(extent, glm::abs(vertex));
+        return extent * 2.0;
+    }
+
+    // triangles of the hull as a list of points for the mesh
+    std::vector<glm::vec3> hull_triangles(const hull::Hull &hull)
+    {
+        std::vector<glm::vec3> result;
+        result.reserve(hull.triangles().size() * 3);
+        for(const auto &triangle : hull.triangles()) {
+            for(const unsigned vertex : triangle)
+                result.push_back(glm::vec3(hull.vertices()[vertex]));
+        }
+        return result;
+    }
+}
 
 Cube::Cube(glm::dvec3 initial_position, glm::dvec3 size, double mass) :
 _position{initial_position}, size{size}, mass{mass}
@@ -35,26 +60,49 @@ Cube::Cube(glm::dvec3 initial_position, glm::dvec3 euler, glm::dvec3 size, doubl
     _compute_derived_variables();
 }
 
+Cube::Cube(glm::dvec3 initial_position, std::shared_ptr<const hull::Hull> hull, double mass) :
+           mass{mass}, size{hull_size(*hull)}, _position{initial_position}, _hull{std::move(hull)}
+{
+    _cube_mesh = new CubeMesh(hull_triangles(*_hull));
+    // computed by the hull once, with the divergence theorem
+    _body_inertia_tensor = _hull->inertia_tensor(mass);
+    _body_inertia_tensor_inv = glm::inverse(_body_inertia_tensor);
+
+    _compute_derived_variables();
+}
+
 void Cube::set_force_and_torque(glm::dvec3 force, glm::dvec3 torque)
 {
     _current_force  = force;
     _current_torque = torque;
 }
 
-#include <iostream>
 void Cube::apply_impulse(const glm::dvec3 &linear, const glm::dvec3 &angular)
 {
-    std::cout << "Before change: " << std::endl;
-    std::cout << "_linear_momentum: (" << _linear_momentum.x << "; " << _linear_momentum.y << "; " << _linear_momentum.z << ")" << std::endl;
-    std::cout << "_angular_momentum: (" << _angular_momentum.x << "; " << _angular_momentum.y << "; " << _angular_momentum.z << ")" << std::endl;
-    std::cout << "_velocity: (" << _velocity.x << "; " << _velocity.y << "; " << _velocity.z << ")" << std::endl;
     _linear_momentum += linear;
     _angular_momentum += angular;
     _compute_derived_variables();
-    std::cout << "After change: " << std::endl;
-    std::cout << "_linear_momentum: (" << _linear_momentum.x << "; " << _linear_momentum.y << "; " << _linear_momentum.z << ")" << std::endl;
-    std::cout << "_velocity: (" << _velocity.x << "; " << _velocity.y << "; " << _velocity.z << ")" << std::endl;
-    
+    wake_up();
+}
+
+void Cube::set_state(const glm::dvec3 &position, const glm::dquat &orientation,
+                     const glm::dvec3 &velocity, const glm::dvec3 &angular_velocity)
+{
+    _position = position;
+    _orientation = glm::normalize(orientation);
+    _linear_momentum = velocity * mass;
+    const glm::dmat3x3 rotation = glm::mat3_cast(_orientation);
+    _angular_momentum = rotation * _body_inertia_tensor * glm::transpose(rotation) * angular_velocity;
+    _compute_derived_variables();
+}
+
+void Cube::correct_position(const glm::dvec3 &translation, const glm::dvec3 &rotation)
+{
+    _position += translation;
+    const double angle = glm::length(rotation);
+    if(angle > 0.0)
+        _orientation = glm::angleAxis(angle, rotation / angle) * _orientation;
+    _compute_derived_variables();
 }
 
 glm::mat4 Cube::get_transform() const
@@ -69,6 +117,22 @@ unsigned Cube::get_cube_mesh() const
     return _cube_mesh->get_vao();
 }
 
+unsigned Cube::get_mesh_vertex_count() const
+{
+    return _cube_mesh->get_vertex_count();
+}
+
+const hull::Hull *Cube::get_hull() const
+{
+    return _hull.get();
+}
+
+unsigned Cube::get_hull_support(const glm::dvec3 &direction, unsigned &hint) const
+{
+    hint = _hull->support(glm::transpose(_orientation_matrix) * direction, hint);
+    return hint;
+}
+
 void Cube::_compute_derived_variables()
 {
     _orientation = glm::normalize(_orientation);
@@ -126,6 +190,18 @@ std::array<glm::dvec4, 6> Cube::get_faces() const
     return result;
 }
 
+// 0---1  4---5
+// | U |  | D |
+// 2---3  6---7
+const std::array<std::array<unsigned, 4>, 6> Cube::face_vertices = {{
+    {0, 1, 3, 2}, // Up
+    {0, 2, 6, 4}, // Left
+    {2, 3, 7, 6}, // Front
+    {1, 5, 7, 3}, // Right
+    {0, 4, 5, 1}, // Back
+    {4, 6, 7, 5}  // Down
+}};
+
 // 0---1  4---5
 // | U |  | D |
 // 2---3  6---7
@@ -153,6 +229,38 @@ std::array<glm::dvec3, 8> Cube::get_vertices() const
     return result;
 }
 
+glm::dvec3 Cube::support(const glm::dvec3 &direction) const
+{
+    if(!_hull) {
+        unsigned unused = 0;
+        return support(direction, unused);
+    }
+
+    std::atomic_ref<unsigned> shared_hint(_support_hint);
+    unsigned hint = shared_hint.load(std::memory_order_relaxed);
+    const glm::dvec3 result = support(direction, hint);
+    shared_hint.store(hint, std::memory_order_relaxed);
+    return result;
+}
+
+glm::dvec3 Cube::support(const glm::dvec3 &direction, unsigned &hint) const
+{
+    if(_hull)
+        return (_orientation_matrix * _hull->vertices()[get_hull_support(direction, hint)]) + _position;
+
+    // convert direction to local coordinate system and pick the matching vertex
+    const glm::dvec3 local = glm::transpose(_orientation_matrix) * direction;
+    const glm::dvec3 vertex = glm::dvec3((local.x >= 0.0) ? size.x/2.0 : size.x/-2.0,
+                                         (local.y >= 0.0) ? size.y/2.0 : size.y/-2.0,
+                                         (local.z >= 0.0) ? size.z/2.0 : size.z/-2.0);
+    return (_orientation_matrix * vertex) + _position;
+}
+
+double Cube::get_radius() const
+{
+    return _hull ? _hull->radius() : glm::length(size) / 2.0;
+}
+
 bool Cube::check_point_on_surface(glm::dvec3 point) const
 {
     // convert point to local coordinate system
@@ -209,6 +317,71 @@ glm::dvec3 Cube::get_position() const
     return _position;
 }
 
+glm::dquat Cube::get_orientation() const
+{
+    return _orientation;
+}
+
+glm::dmat3x3 Cube::get_body_inverse_inertia_tensor() const
+{
+    return _body_inertia_tensor_inv;
+}
+
+glm::dvec3 Cube::get_velocity() const
+{
+    return _velocity;
+}
+
+glm::dvec3 Cube::get_angular_velocity() const
+{
+    return _angular_velocity;
+}
+
+bool Cube::is_awake() const
+{
+    return _awake;
+}
+
+void Cube::wake_up()
+{
+    // impulses on an awake body (e.g. resting contacts) don't restart the countdown
+    if(!_awake)
+        _sleep_time = 0.0;
+    _awake = true;
+}
+
+void Cube::put_to_sleep()
+{
+    _awake = false;
+    _linear_momentum = glm::dvec3(0.0);
+    _angular_momentum = glm::dvec3(0.0);
+    _compute_derived_variables();
+}
+
+double Cube::update_sleep_time(double dt, double linear_threshold, double angular_threshold)
+{
+    if(glm::length(_velocity) > linear_threshold || glm::length(_angular_velocity) > angular_threshold)
+        _sleep_time = 0.0;
+    else
+        _sleep_time += dt;
+    return _sleep_time;
+}
+
+glm::dvec3 Cube::get_angular_momentum() const
+{
+    return _angular_momentum;
+}
+
+glm::dvec3 Cube::get_force() const
+{
+    return _current_force;
+}
+
+glm::dvec3 Cube::get_torque() const
+{
+    return _current_torque;
+}
+
 glm::dvec3 Cube::get_point_r(const glm::dvec3 &point) const
 {
     return glm::inverse(_orientation_matrix) * (point - _position);
@@ -221,7 +394,7 @@ double Cube::get_kinetic_energy() const
 
 glm::dmat3x3 Cube::get_inverse_inertia_tensor() const
 {
-    return _body_inertia_tensor_inv;
+    return _orientation_matrix * _body_inertia_tensor_inv * glm::transpose(_orientation_matrix);
 }
 
 std::array<double, 13> Cube::dxdt()
@@ -303,3 +476,8 @@ void Cube::update_from_array(const std::array<double, 13> &state)
 
     _compute_derived_variables();
 }
+
+glm::dvec3 CubeSupport::support(const glm::dvec3 &direction) const
+{
+    return cube.support(direction, hint);
+}
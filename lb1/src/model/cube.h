@@ -3,7 +3,9 @@
 #include <glm/mat3x3.hpp>
 #include <glm/gtc/quaternion.hpp>
 #include <array>
+#include <memory>
 #include "../view/cube_mesh.h"
+#include "../compute/hull.h"
 
 #define SURFACE_POINT_CHECK_TOLERANCE 0.05
 
@@ -14,18 +16,32 @@ public:
     const glm::dvec3 size;
     Cube(glm::dvec3 initial_position, glm::dvec3 size, double mass);
     Cube(glm::dvec3 initial_position, glm::dvec3 euler, glm::dvec3 size, double mass);
+    // convex polyhedron with its center of mass at initial_position, size is its bounding box
+    Cube(glm::dvec3 initial_position, std::shared_ptr<const hull::Hull> hull, double mass);
 
     glm::mat4 get_transform() const;
 
     void set_force_and_torque(glm::dvec3 force, glm::dvec3 torque);
     void apply_impulse(const glm::dvec3 &linear, const glm::dvec3 &angular);
+    // sets pose and velocities at once, momenta are derived from them
+    void set_state(const glm::dvec3 &position, const glm::dquat &orientation,
+                   const glm::dvec3 &velocity, const glm::dvec3 &angular_velocity);
+    // moves the body without changing its momenta (rotation vector: axis * angle)
+    void correct_position(const glm::dvec3 &translation, const glm::dvec3 &rotation);
     std::array<double, 13> dxdt();
     std::array<double, 13> state_as_array();
     void update_from_array(const std::array<double, 13> &state);
 
     unsigned get_cube_mesh() const;
+    unsigned get_mesh_vertex_count() const;
 
-    // U, L, F, R, B, D
+    // convex polyhedron bodies only, nullptr for boxes
+    const hull::Hull *get_hull() const;
+    // index of the hull vertex farthest along the world direction, hill climbing
+    // from hint, which is set to the result
+    unsigned get_hull_support(const glm::dvec3 &direction, unsigned &hint) const;
+
+    // U, L, F, R, B, D (boxes only, as get_vertices())
     std::array<glm::dvec4, 6> get_faces() const;
 
     // 0---1  4---5
@@ -33,14 +49,38 @@ public:
     // 2---3  6---7
     std::array<glm::dvec3, 8> get_vertices() const;
 
+    // vertices of every face (indices in get_vertices()), faces in get_faces() order
+    static const std::array<std::array<unsigned, 4>, 6> face_vertices;
+
+    // farthest point of the cube along the direction (for GJK)
+    glm::dvec3 support(const glm::dvec3 &direction) const;
+    // same, a hull is searched from hint (see get_hull_support())
+    glm::dvec3 support(const glm::dvec3 &direction, unsigned &hint) const;
+    // radius of the sphere around the center of mass that contains the body
+    double get_radius() const;
+
     bool check_point_on_surface(glm::dvec3 point) const;
     bool check_point_on_edge(glm::dvec3 point) const;
 
     glm::dvec3 get_point_velocity(const glm::dvec3 &point) const;
     glm::dvec3 get_position() const;
-    glm::dmat3x3 get_inverse_inertia_tensor() const;
+    glm::dquat get_orientation() const;
+    glm::dvec3 get_velocity() const;
+    glm::dvec3 get_angular_velocity() const;
+    glm::dvec3 get_angular_momentum() const;
+    glm::dvec3 get_force() const;
+    glm::dvec3 get_torque() const;
+    glm::dmat3x3 get_inverse_inertia_tensor() const; // in world coordinates
+    glm::dmat3x3 get_body_inverse_inertia_tensor() const;
     glm::dvec3 get_point_r(const glm::dvec3 &point) const; // radius-vector    
     double get_kinetic_energy() const;
+
+    // sleeping bodies are not integrated and keep zero velocity
+    bool is_awake() const;
+    void wake_up();
+    void put_to_sleep();
+    // time the body has stayed slower than the thresholds, reset otherwise
+    double update_sleep_time(double dt, double linear_threshold, double angular_threshold);
 private:    
     // State variables
     glm::dvec3 _position;
@@ -57,12 +97,31 @@ private:
     glm::dmat3x3 _orientation_matrix;
     glm::dvec3   _velocity;
     glm::dvec3   _angular_velocity;
-    glm::dvec3   _current_force;
-    glm::dvec3   _current_torque;
+    glm::dvec3   _current_force  = glm::dvec3(0.0);
+    glm::dvec3   _current_torque = glm::dvec3(0.0);
 
     double _full_kinetic_energy = 0;
 
+    bool   _awake = true;
+    double _sleep_time = 0.0;
+
     CubeMesh *_cube_mesh;
 
+    std::shared_ptr<const hull::Hull> _hull;
+    // last hull vertex found by support(), updated atomically as the body
+    // may be queried from several threads
+    mutable unsigned _support_hint = 0;
+
     void _compute_derived_variables();
 };
+
+// Cube as a GJK shape whose hull search starts from a hint owned by the caller
+// (one per pair in the narrow phase): queries of different pairs share no
+// state, so their results don't depend on the order the pairs are run in
+struct CubeSupport {
+    const Cube &cube;
+    unsigned &hint;
+
+    glm::dvec3 support(const glm::dvec3 &direction) const;
+};
+
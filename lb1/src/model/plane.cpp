@@ -0,0 +1,79 @@
+#include "plane.h"
+#include <cmath>
+#include <glm/ext/matrix_transform.hpp>
+
+namespace
+{
+    // any unit vector perpendicular to the normal
+    glm::dvec3 perpendicular(const glm::dvec3 &normal)
+    {
+        const glm::dvec3 axis = (std::abs(normal.x) < 0.9) ? glm::dvec3(1.0, 0.0, 0.0) : glm::dvec3(0.0, 1.0, 0.0);
+        return glm::normalize(glm::cross(normal, axis));
+    }
+}
+
+Plane::Plane(glm::dvec3 point, glm::dvec3 normal) :
+    _point{point}, _normal{glm::normalize(normal)},
+    _half_extents{PLANE_DRAW_SIZE / 2.0, PLANE_DRAW_SIZE / 2.0}, _bounded{false}
+{
+    _tangent = perpendicular(_normal);
+    _bitangent = glm::cross(_normal, _tangent);
+    _cube_mesh = new CubeMesh(glm::vec3(PLANE_DRAW_SIZE, PLANE_DRAW_SIZE, PLANE_THICKNESS));
+}
+
+Plane::Plane(glm::dvec3 point, glm::dvec3 normal, glm::dvec3 tangent, glm::dvec2 half_extents) :
+    _point{point}, _normal{glm::normalize(normal)}, _half_extents{half_extents}, _bounded{true}
+{
+    // tangent is made exactly perpendicular to the normal
+    _tangent = glm::normalize(tangent - _normal * glm::dot(tangent, _normal));
+    _bitangent = glm::cross(_normal, _tangent);
+    _cube_mesh = new CubeMesh(glm::vec3(half_extents.x * 2.0, half_extents.y * 2.0, PLANE_THICKNESS));
+}
+
+glm::mat4 Plane::get_transform() const
+{
+    // the slab lies under the plane, its local z is the normal
+    const glm::dvec3 center = _point - _normal * (PLANE_THICKNESS / 2.0);
+    glm::mat4 transformation_matrix = glm::translate(glm::mat4(1.0f), glm::vec3(center));
+    transformation_matrix *= glm::mat4(glm::dmat3x3(_tangent, _bitangent, _normal));
+    return transformation_matrix;
+}
+
+unsigned Plane::get_cube_mesh() const
+{
+    return _cube_mesh->get_vao();
+}
+
+unsigned Plane::get_mesh_vertex_count() const
+{
+    return _cube_mesh->get_vertex_count();
+}
+
+glm::dvec4 Plane::get_plane() const
+{
+    return glm::dvec4(_normal, -glm::dot(_normal, _point));
+}
+
+glm::dvec3 Plane::get_normal() const
+{
+    return _normal;
+}
+
+glm::dvec3 Plane::get_point() const
+{
+    return _point;
+}
+
+bool Plane::is_bounded() const
+{
+    return _bounded;
+}
+
+bool Plane::contains(const glm::dvec3 &point) const
+{
+    if(!_bounded)
+        return true;
+    const glm::dvec3 offset = point - _point;
+    return std::abs(glm::dot(offset, _tangent)) <= _half_extents.x &&
+           std::abs(glm::dot(offset, _bitangent)) <= _half_extents.y;
+}
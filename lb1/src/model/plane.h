@@ -0,0 +1,39 @@
+#pragma once
+#include <glm/glm.hpp>
+#include "../view/cube_mesh.h"
+
+#define PLANE_THICKNESS 0.2   // of the slab drawn under the plane
+#define PLANE_DRAW_SIZE 100.0 // side of the square drawn for an unbounded plane
+
+// Static collider: the half-space behind a plane, optionally bounded to a
+// rectangle in the plane. It never moves and has infinite mass, so contacts
+// against it need no edge-edge search: the signed distances of the
+// vertices of a box are all there is.
+class Plane
+{
+public:
+    // unbounded half-space dot(normal, x) <= dot(normal, point)
+    Plane(glm::dvec3 point, glm::dvec3 normal);
+    // rectangle centered at point, half extents along tangent and normal x tangent
+    Plane(glm::dvec3 point, glm::dvec3 normal, glm::dvec3 tangent, glm::dvec2 half_extents);
+
+    glm::mat4 get_transform() const;
+    unsigned get_cube_mesh() const;
+    unsigned get_mesh_vertex_count() const;
+
+    // (normal, w) with dot(normal, x) + w = signed distance, like Cube::get_faces()
+    glm::dvec4 get_plane() const;
+    glm::dvec3 get_normal() const;
+    glm::dvec3 get_point() const;
+    bool is_bounded() const;
+    // projection of the point onto the plane lies within the rectangle
+    bool contains(const glm::dvec3 &point) const;
+private:
+    glm::dvec3 _point;
+    glm::dvec3 _normal;
+    glm::dvec3 _tangent, _bitangent;
+    glm::dvec2 _half_extents;
+    bool _bounded;
+
+    CubeMesh *_cube_mesh;
+};
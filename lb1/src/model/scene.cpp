@@ -1,13 +1,21 @@
 #include <glm/ext/vector_double4.hpp>
 #include <glm/fwd.hpp>
 #include <random>
+#include <algorithm>
+#include <numeric>
 
 #include "scene.h"
 #include "../compute/solver.h"
+#include "../compute/manifold.h"
+#include "../compute/impulse_solver.h"
+#include "../compute/resting_contact.h"
+#include "../compute/ccd.h"
+#include "../compute/segment.h"
+#include "../compute/classify.h"
+#include "../compute/morton.h"
 #include <glm/gtx/rotate_vector.hpp>
-#include <iostream>
 
-Scene::Scene()
+Scene::Scene(PhysicsBackend backend) : _backend{backend}
 {
     _camera = new Camera();
     this->rotate_camera(0, 0); // just to update camera position
@@ -16,10 +24,27 @@ Scene::Scene()
     _cubes.emplace_back(glm::dvec3({0.0f, 0.0f, 2.0f}),
                         glm::dvec3({1.0f, 1.0f, 1.0f}), 1.0f);
 
-    // steady one
-    _cubes.emplace_back(glm::dvec3({0.0f, 0.0f, 0.0f}),
-                        glm::dvec3({0.0f, 0.5f, 0.0f}),
-                        glm::dvec3({0.2f, 10.0f, 10.0f}), 10.0f);
+    // inclined plane, 10x10: the upper face of the 0.2x10x10 slab at the origin
+    // with euler angles (0, 0.5, 0), orientation composed as Cube does it
+    const glm::dquat slab = glm::normalize(glm::dquat(0.0, 1.0, 0.0, 0.0) *
+                                           glm::dquat(0.5, 0.0, 1.0, 0.0) *
+                                           glm::dquat(0.0, 0.0, 0.0, 1.0));
+    const glm::dvec3 normal = slab * glm::dvec3(-1.0, 0.0, 0.0); // local -x points up
+    _planes.emplace_back(normal * 0.1, normal, slab * glm::dvec3(0.0, 1.0, 0.0), glm::dvec2({5.0, 5.0}));
+
+    for(const auto &plane : _planes)
+        broad_phase::add(_plane_bounds, plane.get_plane());
+
+    _body_index.resize(_cubes.size());
+    std::iota(_body_index.begin(), _body_index.end(), 0u);
+    _body_handle = _body_index;
+
+    // a full manifold per body to begin with, lists grow to the peak and stay there
+    const std::size_t body_count = _cubes.size() + _planes.size();
+    _contacts.reserve(body_count * MAX_MANIFOLD_POINTS);
+    _transforms.reserve(body_count);
+    _meshes.reserve(body_count);
+    _vertex_counts.reserve(body_count);
 }
 
 Scene::~Scene()
@@ -49,23 +74,383 @@ void Scene::rotate_camera(float angle_x, float angle_y)
     _camera->move(camera_pos);
 }
 
+namespace
+{
+    void integrate(Cube &cube, double dt)
+    {
+        #ifdef USE_EULER
+        solver::euler_solver(cube, dt);
+        #endif
+        #ifdef USE_RK4
+        solver::rk4_solver(cube, dt);
+        #endif
+        #ifdef USE_RK5
+        solver::rk5_solver(cube, dt);
+        #endif
+    }
+
+    // radius of the sphere around the center of mass that contains the cube
+    double bounding_radius(const Cube &cube)
+    {
+        return cube.get_radius();
+    }
+
+    // half size of the axis aligned box around the center of mass that
+    // contains the cube: the box rotated for boxes, the sphere for hulls
+    glm::dvec3 bounding_half_extents(const Cube &cube)
+    {
+        if(cube.get_hull())
+            return glm::dvec3(bounding_radius(cube));
+        const glm::dmat3x3 rotation = glm::mat3_cast(cube.get_orientation());
+        glm::dvec3 result(0.0);
+        for(unsigned axis = 0; axis < 3; axis++)
+            result += glm::abs(rotation[axis]) * (cube.size[axis] / 2.0);
+        return result;
+    }
+
+    // upper bound of the distance by which two cubes can get closer during dt
+    double approach_bound(const Cube &a, const Cube &b, double dt)
+    {
+        return (glm::length(a.get_velocity() - b.get_velocity()) +
+                glm::length(a.get_angular_velocity()) * bounding_radius(a) +
+                glm::length(b.get_angular_velocity()) * bounding_radius(b)) * dt;
+    }
+
+    // lower bound of the distance between two cubes
+    double gap_bound(const Cube &a, const Cube &b)
+    {
+        return glm::length(a.get_position() - b.get_position()) - bounding_radius(a) - bounding_radius(b);
+    }
+
+    // cells of the pairs of moving bodies
+    constexpr std::array<unsigned, 3> CUBE_CELLS = {
+        narrow_phase::cell(narrow_phase::Shape::BOX,  narrow_phase::Shape::BOX),
+        narrow_phase::cell(narrow_phase::Shape::BOX,  narrow_phase::Shape::HULL),
+        narrow_phase::cell(narrow_phase::Shape::HULL, narrow_phase::Shape::HULL)
+    };
+    // cells of the pairs of a moving body and a static plane
+    constexpr std::array<unsigned, 2> PLANE_CELLS = {
+        narrow_phase::cell(narrow_phase::Shape::BOX,  narrow_phase::Shape::PLANE),
+        narrow_phase::cell(narrow_phase::Shape::HULL, narrow_phase::Shape::PLANE)
+    };
+
+    // upper bound of the distance by which a cube can get closer to a static plane during dt
+    double approach_bound(const Cube &cube, const Plane &plane, double dt)
+    {
+        return (std::max(-glm::dot(cube.get_velocity(), plane.get_normal()), 0.0) +
+                glm::length(cube.get_angular_velocity()) * bounding_radius(cube)) * dt;
+    }
+
+    // signed distance of the deepest point of a cube from the plane (of a bounded one too)
+    double plane_distance(const Cube &cube, const Plane &plane)
+    {
+        const glm::dvec4 p = plane.get_plane();
+        return glm::dot(glm::dvec3(p), cube.support(-glm::dvec3(p))) + p.w;
+    }
+
+    ccd::Motion motion_of(const Cube &cube)
+    {
+        return {cube.get_position(), cube.get_velocity(), cube.get_angular_velocity(), bounding_radius(cube)};
+    }
+}
+
 void Scene::update(float dt)
-{    
-    #ifdef USE_EULER
-    solver::euler_solver(_cubes[0], dt);
-    solver::euler_solver(_cubes[1], dt);
-    #endif
-    #ifdef USE_RK4
-    solver::rk4_solver(_cubes[0], dt);
-    solver::rk4_solver(_cubes[1], dt);
-    #endif
-    #ifdef USE_RK5
-    solver::rk5_solver(_cubes[0], dt);
-    solver::rk5_solver(_cubes[1], dt);
+{
+    if(REORDER_INTERVAL > 0 && ++_frames_since_reorder >= REORDER_INTERVAL) {
+        _frames_since_reorder = 0;
+        _reorder_bodies();
+    }
+
+    if(_backend == PhysicsBackend::XPBD) {
+        _step_xpbd(dt);
+        return;
+    }
+
+    // fast bodies could pass through each other or end up deep inside during
+    // the frame: the frame is cut at the time of impact and the rest is
+    // simulated after the contact is resolved
+    double remaining = dt;
+    for(unsigned substep = 1; remaining > 0.0; substep++) {
+        const bool last = (substep == CCD_MAX_SUBSTEPS);
+        #ifdef USE_CCD
+        const double step = last ? remaining : _time_of_impact(remaining);
+        #else
+        const double step = remaining;
+        #endif
+        remaining -= _step(step, !last);
+    }
+}
+
+double Scene::_time_of_impact(double dt)
+{
+    _find_pairs(dt);
+    double toi = dt;
+    for(const unsigned cell : CUBE_CELLS) {
+        for(const auto &[a, b] : _pairs[cell]) {
+            // slow pairs are handled by regular contacts and event location,
+            // far ones can't meet
+            const double sweep = approach_bound(_cubes[a], _cubes[b], dt);
+            if(sweep <= CONTACT_EPSILON || gap_bound(_cubes[a], _cubes[b]) > sweep)
+                continue;
+
+            // pairs already within CONTACT_EPSILON get their contacts resolved
+            // at the beginning of the step
+            PairCache &cache = _pair_cache.at(std::make_pair(a, b));
+            const gjk::Result gjk_result = gjk::distance(CubeSupport{_cubes[a], cache.support_hints[0]},
+                                                         CubeSupport{_cubes[b], cache.support_hints[1]}, cache.simplex);
+            if(gjk_result.intersecting || gjk_result.distance <= CONTACT_EPSILON)
+                continue;
+            const double t = ccd::time_of_impact(_cubes[a], motion_of(_cubes[a]), _cubes[b], motion_of(_cubes[b]),
+                                                 toi, CONTACT_EPSILON / 2.0);
+            toi = std::min(toi, t);
+        }
+    }
+    // the same against the planes, by the distance of the deepest point
+    for(const unsigned cell : PLANE_CELLS) {
+        for(const auto &[a, b] : _pairs[cell]) {
+            const Plane &plane = _planes[b - _cubes.size()];
+            const double sweep = approach_bound(_cubes[a], plane, dt);
+            const double distance = plane_distance(_cubes[a], plane);
+            if(sweep <= CONTACT_EPSILON || distance > sweep || distance <= CONTACT_EPSILON)
+                continue;
+            const double t = ccd::time_of_impact(_cubes[a], motion_of(_cubes[a]), plane.get_plane(),
+                                                 toi, CONTACT_EPSILON / 2.0);
+            toi = std::min(toi, t);
+        }
+    }
+    return toi;
+}
+
+std::vector<solver::EventFunction> Scene::_impact_events(double dt)
+{
+    // the contact impulses changed the velocities since get_contacts()
+    _find_pairs(dt);
+    std::vector<solver::EventFunction> events;
+    for(const unsigned cell : CUBE_CELLS) {
+        for(const auto &[a, b] : _pairs[cell]) {
+            if(gap_bound(_cubes[a], _cubes[b]) > approach_bound(_cubes[a], _cubes[b], dt))
+                continue;
+
+            // signed separation, zero in the middle of the contact zone
+            PairCache &cache = _pair_cache.at(std::make_pair(a, b));
+            auto separation = [this, a, b, &cache]() {
+                const gjk::Result result = gjk::collide(CubeSupport{_cubes[a], cache.support_hints[0]},
+                                                        CubeSupport{_cubes[b], cache.support_hints[1]}, cache.simplex);
+                return (result.intersecting ? -result.depth : result.distance) - CONTACT_EPSILON / 2.0;
+            };
+            // pairs already in contact are left to the contact solver
+            if(separation() < CONTACT_EPSILON / 2.0)
+                continue;
+            events.push_back(separation);
+        }
+    }
+    for(const unsigned cell : PLANE_CELLS) {
+        for(const auto &[a, b] : _pairs[cell]) {
+            const Plane &plane = _planes[b - _cubes.size()];
+            if(plane_distance(_cubes[a], plane) > approach_bound(_cubes[a], plane, dt))
+                continue;
+
+            auto separation = [this, a, &plane]() {
+                return plane_distance(_cubes[a], plane) - CONTACT_EPSILON / 2.0;
+            };
+            if(separation() < CONTACT_EPSILON / 2.0)
+                continue;
+            events.push_back(separation);
+        }
+    }
+    return events;
+}
+
+double Scene::_step(double dt, bool locate_events)
+{
+    // external forces, contact forces are added in process_resting_contacts()
+    for(auto &cube : _cubes)
+        cube.set_force_and_torque(GRAVITY * cube.mass, glm::dvec3({0, 0, 0}));
+
+    // contacts are resolved before the bodies move, so velocities changed
+    // since the last step (impulses from the outside) are covered too
+    _frame_arena.reset();
+    #ifdef USE_SPECULATIVE_CONTACTS
+    auto &contacts = get_contacts(dt);
+    #else
+    auto &contacts = get_contacts();
     #endif
-    _cubes[0].set_force_and_torque(glm::dvec3({0, 0, 0}), glm::dvec3({0, 0, 0}));
-    auto contacts = get_contacts();
-    process_contacts(contacts);
+    _build_islands(contacts);
+    process_contacts(contacts, dt);
+    process_resting_contacts(contacts);
+
+    // sleeping bodies are skipped by the integrator
+    std::pmr::vector<Cube*> awake(&_frame_arena);
+    for(auto &cube : _cubes) {
+        if(cube.is_awake())
+            awake.push_back(&cube);
+    }
+    // the step ends early at the first impact inside it
+    const auto events = locate_events ? _impact_events(dt) : std::vector<solver::EventFunction>();
+    dt = solver::solve_with_events<Cube>(awake, dt, integrate, events);
+
+    _update_sleep(dt);
+    return dt;
+}
+
+void Scene::_step_xpbd(double dt)
+{
+    for(auto &cube : _cubes)
+        cube.set_force_and_torque(GRAVITY * cube.mass, glm::dvec3({0, 0, 0}));
+
+    // contacts of the whole frame, including the ones that may appear during it
+    _frame_arena.reset();
+    auto &contacts = get_contacts(dt);
+    _build_islands(contacts);
+
+    // sleeping bodies take part as static ones
+    std::pmr::vector<xpbd::Body> bodies(&_frame_arena);
+    bodies.reserve(_cubes.size() + contacts.size());
+    for(const auto &cube : _cubes) {
+        const bool awake = cube.is_awake();
+        bodies.push_back({cube.get_position(), cube.get_orientation(),
+                          cube.get_velocity(), cube.get_angular_velocity(),
+                          cube.get_force(), cube.get_torque(),
+                          awake ? 1.0 / cube.mass : 0.0,
+                          awake ? cube.get_body_inverse_inertia_tensor() : glm::dmat3x3(0.0)});
+    }
+
+    // anchors on the surface of each body: the contact point lies halfway
+    // between them, depth apart when penetrating and gap apart when not
+    std::pmr::vector<xpbd::Contact> constraints(&_frame_arena);
+    constraints.reserve(contacts.size());
+    for(const auto &contact : contacts) {
+        const glm::dvec3 normal = glm::normalize(contact.normal);
+        const glm::dvec3 offset = normal * ((contact.gap - contact.depth) / 2.0);
+        unsigned body_b = contact.body_b;
+        // a static plane is an immovable body anchored at the contact point,
+        // one per contact, so the plane isn't shared between constraints
+        if(_is_static(body_b)) {
+            body_b = bodies.size();
+            bodies.push_back({contact.point - offset, glm::dquat(1.0, 0.0, 0.0, 0.0),
+                              glm::dvec3(0.0), glm::dvec3(0.0), glm::dvec3(0.0), glm::dvec3(0.0),
+                              0.0, glm::dmat3x3(0.0)});
+        }
+        constraints.push_back(xpbd::make_contact(bodies, contact.body_a, body_b,
+                                                 contact.point + offset, contact.point - offset, normal));
+    }
+
+    const double h = dt / XPBD_SUBSTEPS;
+    for(unsigned substep = 0; substep < XPBD_SUBSTEPS; substep++) {
+        for(auto &constraint : constraints)
+            constraint.normal_velocity = xpbd::normal_velocity(bodies, constraint);
+        for(auto &body : bodies)
+            xpbd::integrate(body, h);
+        xpbd::solve_positions(bodies, constraints, h);
+        for(auto &body : bodies)
+            xpbd::update_velocities(body, h);
+        xpbd::solve_velocities(bodies, constraints, RESTITUTION, MIN_COLLISION_SPEED);
+    }
+
+    for(std::size_t i = 0; i < _cubes.size(); i++) {
+        if(_cubes[i].is_awake())
+            _cubes[i].set_state(bodies[i].position, bodies[i].orientation,
+                                bodies[i].velocity, bodies[i].angular_velocity);
+    }
+
+    _store_manifolds(contacts);
+    _update_sleep(dt);
+}
+
+void Scene::_build_islands(const std::vector<Contact> &contacts)
+{
+    std::pmr::vector<std::pair<unsigned, unsigned>> edges(&_frame_arena);
+    edges.reserve(contacts.size());
+    // static bodies don't connect islands: the contact belongs to the island of body A
+    for(const auto &contact : contacts)
+        edges.emplace_back(contact.body_a, _is_static(contact.body_b) ? contact.body_a : contact.body_b);
+    islands::build(_cubes.size(), edges, _islands, &_frame_arena);
+
+    // new contact with an awake body wakes the whole island
+    for(const auto &island : _islands) {
+        const bool awake = std::any_of(island.bodies.begin(), island.bodies.end(),
+                                       [this](unsigned body) { return _cubes[body].is_awake(); });
+        if(!awake)
+            continue;
+        for(const unsigned body : island.bodies) {
+            if(!_cubes[body].is_awake())
+                _cubes[body].wake_up();
+        }
+    }
+}
+
+void Scene::_reorder_bodies()
+{
+    std::pmr::vector<glm::dvec3> positions(&_frame_arena);
+    positions.reserve(_cubes.size());
+    for(const auto &cube : _cubes)
+        positions.push_back(cube.get_position());
+    // order[new index] = old index, new_index is the inverse
+    std::pmr::vector<unsigned> order(_cubes.size(), &_frame_arena);
+    morton::sort(positions, order, &_frame_arena);
+    std::pmr::vector<unsigned> new_index(_cubes.size(), &_frame_arena);
+    unsigned moved = 0;
+    for(unsigned i = 0; i < order.size(); i++) {
+        new_index[order[i]] = i;
+        moved += (order[i] != i);
+    }
+    if(moved == 0)
+        return;
+
+    // bodies are moved to the spare list, which then takes the place of
+    // _cubes; both keep their capacity for the next time
+    _reordered_cubes.clear();
+    for(unsigned i = 0; i < order.size(); i++) {
+        _reordered_cubes.push_back(std::move(_cubes[order[i]]));
+        _body_index[_body_handle[order[i]]] = i;
+    }
+    _cubes.swap(_reordered_cubes);
+    _reordered_cubes.clear();
+    for(unsigned i = 0; i < _body_index.size(); i++)
+        _body_handle[_body_index[i]] = i;
+
+    // pair caches are moved to the new keys without reallocating their nodes;
+    // a pair of the same shapes is keyed with the lower index first, if the
+    // order turned around its cached features refer to the wrong bodies, so
+    // the pair starts over
+    auto remap = [&](unsigned body) { return _is_static(body) ? body : new_index[body]; };
+    std::map<std::pair<unsigned, unsigned>, PairCache> pair_cache;
+    while(!_pair_cache.empty()) {
+        auto node = _pair_cache.extract(_pair_cache.begin());
+        auto &[a, b] = node.key();
+        a = remap(a);
+        b = remap(b);
+        if(_shape_of(a) == _shape_of(b) && a > b) {
+            std::swap(a, b);
+            node.mapped() = PairCache();
+        }
+        for(auto &contact : node.mapped().manifold) {
+            contact.body_a = remap(contact.body_a);
+            contact.body_b = remap(contact.body_b);
+        }
+        pair_cache.insert(std::move(node));
+    }
+    _pair_cache = std::move(pair_cache);
+}
+
+void Scene::_update_sleep(double dt)
+{
+    for(const auto &island : _islands) {
+        if(!_cubes[island.bodies.front()].is_awake())
+            continue;
+
+        // island sleeps only when all of its bodies are slow long enough
+        double min_sleep_time = TIME_TO_SLEEP;
+        for(const unsigned body : island.bodies) {
+            const double sleep_time = _cubes[body].update_sleep_time(dt, SLEEP_LINEAR_VELOCITY, SLEEP_ANGULAR_VELOCITY);
+            min_sleep_time = std::min(min_sleep_time, sleep_time);
+        }
+
+        if(min_sleep_time >= TIME_TO_SLEEP) {
+            for(const unsigned body : island.bodies)
+                _cubes[body].put_to_sleep();
+        }
+    }
 }
 
 void Scene::apply_action()
@@ -73,304 +458,862 @@ void Scene::apply_action()
     static bool applied = false;
     // _cubes[0].set_force_and_torque(glm::dvec3({0, 0, -1}), glm::dvec3({0, 0, 0}));
     if(!applied) {
-        _cubes[0].apply_impulse(glm::dvec3{0, 0, -2.5}, glm::dvec3{0, 0, 0});
+        _cubes[_body_index[0]].apply_impulse(glm::dvec3{0, 0, -2.5}, glm::dvec3{0, 0, 0});
         applied = true;
     }
 }
 
-void Scene::process_contacts(const std::vector<Contact> &contacts)
+void Scene::process_contacts(std::vector<Contact> &contacts, double dt)
 {
-    std::array<glm::dvec3, 2> resulting_forces  = {glm::dvec3(0.0, 0.0, 0.0), glm::dvec3(0.0, 0.0, 0.0)};
-    std::array<glm::dvec3, 2> resulting_torques = {glm::dvec3(0.0, 0.0, 0.0), glm::dvec3(0.0, 0.0, 0.0)};
-    unsigned sum_elements = 0;
+    std::pmr::vector<impulse_solver::Body> bodies(&_frame_arena);
+    bodies.reserve(_cubes.size() + contacts.size());
+    for(const auto &cube : _cubes) {
+        bodies.push_back({cube.get_velocity(), cube.get_angular_velocity(),
+                          1.0 / cube.mass, cube.get_inverse_inertia_tensor()});
+    }
 
-    for(const auto &contact : contacts) {
-        // calculate relative velocity of cubes at the contact point
-        const glm::dvec3 cube0_pv = _cubes[contact.body_a].get_point_velocity(contact.point);
-        const glm::dvec3 cube1_pv = _cubes[contact.body_b].get_point_velocity(contact.point);
-        const glm::dvec3 normal_unit = glm::normalize(contact.normal);
-        const double contact_velocity = glm::dot(normal_unit, cube0_pv - cube1_pv);
-        // std::cout << "contact.point: (" << contact.point.x << "; " << contact.point.y << "; " << contact.point.z << ")" << std::endl;
-        // std::cout << "contact.normal: (" << contact.normal.x << "; " << contact.normal.y << "; " << contact.normal.z << ")" << std::endl;
-        // std::cout << "cube0_pv: (" << cube0_pv.x << "; " << cube0_pv.y << "; " << cube0_pv.z << ")" << std::endl;
-        // std::cout << "cube1_pv: (" << cube1_pv.x << "; " << cube1_pv.y << "; " << cube1_pv.z << ")" << std::endl;
-        // std::cout << "Vertex to face: " << contact.vertex_to_face << std::endl;
-        std::cout << "Contact velocity: " << contact_velocity << std::endl;
-
-        if(contact_velocity < -MIN_COLLISION_SPEED) {
-            // const glm::dvec3 ra = _cubes[contact.body_a].get_point_r(contact.point);
-            // const glm::dvec3 rb = _cubes[contact.body_b].get_point_r(contact.point);
-            const glm::dvec3 ra = (contact.point) - _cubes[contact.body_a].get_position();
-            const glm::dvec3 rb = (contact.point) - _cubes[contact.body_b].get_position();
-
-            double bouncy = 1.0;
-            #ifdef ELASTIC
-                #ifdef USE_RK4
-                bouncy = 3.576;
-                #endif
-                #ifdef USE_RK5
-                bouncy = 3.57529;
-                #endif
-            #endif
-            const double num = -(1.0 + bouncy) * contact_velocity;
-            const double denom = (1.0 / _cubes[contact.body_a].mass) +
-                                 (1.0 / _cubes[contact.body_b].mass) +
-                                 glm::dot(normal_unit, glm::cross(_cubes[contact.body_a].get_inverse_inertia_tensor() * glm::cross(ra, normal_unit), ra)) +
-                                 glm::dot(normal_unit, glm::cross(_cubes[contact.body_b].get_inverse_inertia_tensor() * glm::cross(rb, normal_unit), rb));
-
-            const double j = num / denom;
-            const glm::dvec3 force = j * normal_unit;
-            const glm::dvec3 torque_a = glm::cross(ra, force);
-            const glm::dvec3 torque_b = glm::cross(rb, force);
-            // const glm::dvec3 torque_a = {0,0,0};
-            // const glm::dvec3 torque_b = {0,0,0};
-
-            // std::cout << "Applied impulse:" << std::endl;
-            // std::cout << "force: (" << force.x << "; " << force.y << "; " << force.z << ")" << std::endl;
-            // std::cout << "torque_a: (" << torque_a.x << "; " << torque_a.y << "; " << torque_a.z << ")" << std::endl;
-            // std::cout << "torque_b: (" << torque_b.x << "; " << torque_b.y << "; " << torque_b.z << ")" << std::endl;
-
-            resulting_forces[contact.body_a]  += force;
-            resulting_torques[contact.body_a] += torque_a;
-            resulting_forces[contact.body_b]  += -force;
-            resulting_torques[contact.body_b] += -torque_b;
-            ++sum_elements;
+    std::pmr::vector<impulse_solver::Constraint> constraints(contacts.size(), &_frame_arena);
+    for(std::size_t i = 0; i < contacts.size(); i++) {
+        impulse_solver::Constraint &c = constraints[i];
+        c.body_a = contacts[i].body_a;
+        c.body_b = contacts[i].body_b;
+        c.normal = glm::normalize(contacts[i].normal);
+        c.ra = contacts[i].point - _cubes[c.body_a].get_position();
+        if(_is_static(c.body_b)) {
+            // every contact with a static plane gets an immovable body of its own,
+            // so islands touching the same plane don't write to a shared body
+            c.body_b = bodies.size();
+            c.rb = glm::dvec3(0.0);
+            bodies.push_back({glm::dvec3(0.0), glm::dvec3(0.0), 0.0, glm::dmat3x3(0.0)});
+        } else {
+            c.rb = contacts[i].point - _cubes[c.body_b].get_position();
         }
-        std::cout << std::endl;
+        c.impulse = contacts[i].normal_impulse;
+        // Baumgarte with slop, but applied to pseudo velocities only
+        if(dt > 0.0)
+            c.bias = std::max(contacts[i].depth - PENETRATION_SLOP, 0.0) * POSITION_CORRECTION / dt;
     }
-    if(sum_elements != 0) {
-        resulting_forces[0] /= sum_elements;
-        resulting_forces[1] /= sum_elements;
-        resulting_torques[0] /= sum_elements;
-        resulting_torques[1] /= sum_elements;
-        std::cout << "Applied impulse:" << std::endl;
-        std::cout << "resulting_forces[0]: (" << resulting_forces[0].x << "; " << resulting_forces[0].y << "; " << resulting_forces[0].z << ")" << std::endl;
-        std::cout << "resulting_forces[1]: (" << resulting_forces[1].x << "; " << resulting_forces[1].y << "; " << resulting_forces[1].z << ")" << std::endl;
-        std::cout << "resulting_torques[0]: (" << resulting_torques[0].x << "; " << resulting_torques[0].y << "; " << resulting_torques[0].z << ")" << std::endl;
-        std::cout << "resulting_torques[1]: (" << resulting_torques[1].x << "; " << resulting_torques[1].y << "; " << resulting_torques[1].z << ")" << std::endl;
-        _cubes[0].apply_impulse(resulting_forces[0], resulting_torques[0]);
-        _cubes[1].apply_impulse(resulting_forces[1], resulting_torques[1]);
+
+    // islands share no bodies, so each one is solved on its own and writes
+    // only to its bodies and constraints: the result doesn't depend on scheduling
+    auto solve_island = [&](unsigned index, bool colored) {
+        const islands::Island &island = _islands[index];
+        std::pmr::vector<impulse_solver::Constraint> island_constraints(&_frame_arena);
+        island_constraints.reserve(island.contacts.size());
+        for(const unsigned contact : island.contacts) {
+            impulse_solver::prepare(bodies, constraints[contact], RESTITUTION, MIN_COLLISION_SPEED);
+            // speculative contact: only the approach faster than closing the gap is removed
+            if(contacts[contact].gap > 0.0 && dt > 0.0)
+                constraints[contact].target = -contacts[contact].gap / dt;
+            island_constraints.push_back(constraints[contact]);
+        }
+
+        // warm start with impulses of the persistent contacts, then iterate
+        impulse_solver::warm_start(bodies, island_constraints);
+        if(colored) {
+            const auto coloring = impulse_solver::color(island_constraints, bodies.size());
+            impulse_solver::solve_colored(bodies, island_constraints, coloring, _thread_pool);
+        } else {
+            impulse_solver::solve(bodies, island_constraints);
+        }
+        impulse_solver::solve_positions(bodies, island_constraints);
+
+        for(std::size_t i = 0; i < island.contacts.size(); i++)
+            constraints[island.contacts[i]] = island_constraints[i];
+    };
+
+    const auto batches = _island_batches(COLORED_ISLAND_CONTACTS);
+    _thread_pool.parallel_for(batches.size(), [&](std::size_t batch) {
+        for(const unsigned index : batches[batch])
+            solve_island(index, false);
+    });
+    // a single large island would keep one thread busy: its constraints are
+    // split into colors and every color is solved by all threads
+    for(unsigned index = 0; index < _islands.size(); index++) {
+        if(_islands[index].contacts.size() > COLORED_ISLAND_CONTACTS)
+            solve_island(index, true);
+    }
+
+    for(std::size_t i = 0; i < _cubes.size(); i++) {
+        if(bodies[i].linear_impulse != glm::dvec3(0.0) || bodies[i].angular_impulse != glm::dvec3(0.0))
+            _cubes[i].apply_impulse(bodies[i].linear_impulse, bodies[i].angular_impulse);
+        if(bodies[i].pseudo_velocity != glm::dvec3(0.0) || bodies[i].pseudo_angular_velocity != glm::dvec3(0.0))
+            _cubes[i].correct_position(bodies[i].pseudo_velocity * dt, bodies[i].pseudo_angular_velocity * dt);
     }
+
+    for(std::size_t i = 0; i < contacts.size(); i++)
+        contacts[i].normal_impulse = constraints[i].impulse;
 }
 
-std::vector<Contact> Scene::get_contacts() const
+void Scene::process_resting_contacts(std::vector<Contact> &contacts)
 {
-    std::vector<Contact> result;
-    
-    // check for vertex to face contacts first
-    // Step 1. Search for separating plane
-    auto faces0 = _cubes[0].get_faces();
-    auto faces1 = _cubes[1].get_faces();
+    std::pmr::vector<resting_contact::Body> bodies(&_frame_arena);
+    bodies.reserve(_cubes.size() + contacts.size());
+    for(const auto &cube : _cubes) {
+        bodies.push_back({cube.get_velocity(), cube.get_angular_velocity(), cube.get_angular_momentum(),
+                          cube.get_force(), cube.get_torque(),
+                          1.0 / cube.mass, cube.get_inverse_inertia_tensor()});
+    }
+
+    // only contacts that neither approach nor separate after the impulses
+    std::pmr::vector<bool> resting(contacts.size(), false, &_frame_arena);
+    std::pmr::vector<resting_contact::Constraint> constraints(contacts.size(), &_frame_arena);
+    for(std::size_t i = 0; i < contacts.size(); i++) {
+        const Contact &contact = contacts[i];
+        const glm::dvec3 normal = glm::normalize(contact.normal);
+        const glm::dvec3 velocity_b = _is_static(contact.body_b) ? glm::dvec3(0.0) :
+                                      _cubes[contact.body_b].get_point_velocity(contact.point);
+        const double rel_vel = glm::dot(normal, _cubes[contact.body_a].get_point_velocity(contact.point) - velocity_b);
+        // bodies of speculative contacts don't touch yet
+        if(std::abs(rel_vel) > MIN_COLLISION_SPEED || contact.gap > 0.0) {
+            contacts[i].normal_force = 0.0;
+            continue;
+        }
+
+        resting_contact::Constraint &c = constraints[i];
+        c.body_a = contact.body_a;
+        c.body_b = contact.body_b;
+        c.normal = normal;
+        c.ra = contact.point - _cubes[contact.body_a].get_position();
+        if(_is_static(c.body_b)) {
+            // same as for the impulses: an immovable body per static contact
+            c.body_b = bodies.size();
+            c.rb = glm::dvec3(0.0);
+            bodies.push_back({glm::dvec3(0.0), glm::dvec3(0.0), glm::dvec3(0.0),
+                              glm::dvec3(0.0), glm::dvec3(0.0), 0.0, glm::dmat3x3(0.0)});
+        } else {
+            c.rb = contact.point - _cubes[contact.body_b].get_position();
+        }
+        c.force = contact.normal_force;
+        resting[i] = true;
+    }
+
+    // same island decomposition as for the impulses
+    const auto batches = _island_batches();
+    _thread_pool.parallel_for(batches.size(), [&](std::size_t batch) {
+        for(const unsigned index : batches[batch]) {
+            const islands::Island &island = _islands[index];
+            std::pmr::vector<resting_contact::Constraint> island_constraints(&_frame_arena);
+            std::pmr::vector<unsigned> island_contacts(&_frame_arena);
+            for(const unsigned contact : island.contacts) {
+                if(!resting[contact])
+                    continue;
+                island_constraints.push_back(constraints[contact]);
+                island_contacts.push_back(contact);
+            }
+
+            resting_contact::solve(bodies, island_constraints, &_frame_arena);
 
-    auto vertices0 = _cubes[0].get_vertices();
-    auto vertices1 = _cubes[1].get_vertices();
+            for(std::size_t i = 0; i < island_contacts.size(); i++)
+                constraints[island_contacts[i]] = island_constraints[i];
+        }
+    });
+
+    std::pmr::vector<glm::dvec3> forces(bodies.size(), glm::dvec3(0.0), &_frame_arena);
+    std::pmr::vector<glm::dvec3> torques(bodies.size(), glm::dvec3(0.0), &_frame_arena);
+    for(std::size_t i = 0; i < contacts.size(); i++) {
+        if(!resting[i])
+            continue;
+        const resting_contact::Constraint &c = constraints[i];
+        const glm::dvec3 force = c.normal * c.force;
+        forces[c.body_a]  += force;
+        torques[c.body_a] += glm::cross(c.ra, force);
+        forces[c.body_b]  -= force;
+        torques[c.body_b] -= glm::cross(c.rb, force);
+        contacts[i].normal_force = c.force;
+    }
+    for(std::size_t i = 0; i < _cubes.size(); i++) {
+        if(forces[i] != glm::dvec3(0.0) || torques[i] != glm::dvec3(0.0))
+            _cubes[i].set_force_and_torque(bodies[i].force + forces[i], bodies[i].torque + torques[i]);
+    }
+
+    _store_manifolds(contacts);
+}
 
-    struct sep_plane {
-        glm::dvec4 plane;
-        bool from_cube_0;
-        sep_plane(glm::dvec4 plane, bool from_cube_0) :
-            plane{plane}, from_cube_0{from_cube_0} {}
+void Scene::_store_manifolds(const std::vector<Contact> &contacts)
+{
+    // store manifolds with accumulated impulses and forces for the next frame,
+    // sleeping pairs keep theirs to warm-start when woken up; the caches of
+    // moving pairs the broad phase didn't find this step are dropped, so the
+    // map holds the pairs that are close, not every pair that ever was
+    for(auto it = _pair_cache.begin(); it != _pair_cache.end();) {
+        PairCache &cache = it->second;
+        if(_is_awake(it->first.first) || _is_awake(it->first.second)) {
+            if(!cache.candidate) {
+                it = _pair_cache.erase(it);
+                continue;
+            }
+            cache.manifold.clear();
+        }
+        cache.candidate = false;
+        ++it;
+    }
+    for(const auto &contact : contacts)
+        _pair_cache[std::make_pair(contact.body_a, contact.body_b)].manifold.push_back(contact);
+}
+
+std::pmr::vector<std::pmr::vector<unsigned>> Scene::_island_batches(std::size_t max_cost)
+{
+    // cost estimate of an island is its contact count: large islands get a
+    // task of their own, small ones are packed together up to ISLAND_BATCH_COST
+    std::pmr::vector<std::pair<std::size_t, std::pmr::vector<unsigned>>> batches(&_frame_arena);
+    std::pmr::vector<unsigned> small(&_frame_arena);
+    std::size_t small_cost = 0;
+    for(unsigned i = 0; i < _islands.size(); i++) {
+        const std::size_t cost = _islands[i].contacts.size();
+        if(cost == 0 || cost > max_cost)
+            continue;
+        if(cost >= ISLAND_BATCH_COST) {
+            batches.emplace_back(cost, std::pmr::vector<unsigned>({i}, &_frame_arena));
+            continue;
+        }
+        small.push_back(i);
+        small_cost += cost;
+        if(small_cost >= ISLAND_BATCH_COST) {
+            batches.emplace_back(small_cost, std::move(small));
+            small.clear();
+            small_cost = 0;
+        }
+    }
+    if(!small.empty())
+        batches.emplace_back(small_cost, std::move(small));
+
+    // the most expensive ones first to balance the threads, ties in island
+    // order (stable_sort would allocate its buffer outside the arena)
+    std::sort(batches.begin(), batches.end(), [](const auto &x, const auto &y) {
+        return x.first != y.first ? x.first > y.first : x.second.front() < y.second.front();
+    });
+
+    std::pmr::vector<std::pmr::vector<unsigned>> result(&_frame_arena);
+    result.reserve(batches.size());
+    for(auto &batch : batches)
+        result.push_back(std::move(batch.second));
+    return result;
+}
+
+void Scene::_match_manifold(const PairCache &cache, std::vector<Contact> &result, std::size_t first) const
+{
+    // every old contact warm-starts one new contact at most, else its impulse
+    // is applied several times; bit i = contact i taken (only the first 64
+    // of either list are matched, a manifold is far smaller)
+    std::uint64_t old_taken = 0, new_taken = 0;
+    const std::size_t old_count = std::min<std::size_t>(cache.manifold.size(), 64);
+    const std::size_t new_count = std::min<std::size_t>(result.size() - first, 64);
+    auto take = [&](std::size_t i, std::size_t j) {
+        result[first + i].normal_impulse = cache.manifold[j].normal_impulse;
+        result[first + i].normal_force = cache.manifold[j].normal_force;
+        new_taken |= std::uint64_t(1) << i;
+        old_taken |= std::uint64_t(1) << j;
     };
-    
-    static std::vector<sep_plane> prev_sep_planes;
-    std::vector<sep_plane> curr_sep_planes;
-    
-    for(const auto &face : faces0) {
-        glm::dvec3 normal = glm::dvec3(face.x, face.y, face.z);
-        double D = face.w * -1.0;
-        bool face_ok = true;
-        for(const auto &vertex : vertices1) {
-            if(!solver::check_value_greater(glm::dot(normal, vertex), D, CONTACT_EPSILON)) {
-                face_ok = false;
+
+    // same features: that's the same contact point
+    for(std::size_t i = 0; i < new_count; i++) {
+        for(std::size_t j = 0; j < old_count; j++) {
+            if(!(old_taken >> j & 1) && cache.manifold[j].feature == result[first + i].feature) {
+                take(i, j);
                 break;
             }
         }
+    }
 
-        if(face_ok) {
-            curr_sep_planes.emplace_back(face, true);
-            break;
+    // otherwise take the closest one left
+    for(std::size_t i = 0; i < new_count; i++) {
+        if(new_taken >> i & 1)
+            continue;
+        std::size_t match = old_count;
+        double best_dist = MANIFOLD_MATCH_DISTANCE;
+        for(std::size_t j = 0; j < old_count; j++) {
+            const double dist = glm::length(cache.manifold[j].point - result[first + i].point);
+            if(!(old_taken >> j & 1) && dist <= best_dist) {
+                best_dist = dist;
+                match = j;
+            }
         }
+        if(match != old_count)
+            take(i, match);
     }
+}
 
-    // search for another vector of faces
-    for(const auto &face : faces1) {
-        glm::dvec3 normal = glm::dvec3(face.x, face.y, face.z);
-        double D = face.w * -1.0;
-        bool face_ok = true;
-        for(const auto &vertex : vertices0) {
-            if(!solver::check_value_greater(glm::dot(normal, vertex), D, CONTACT_EPSILON)) {
-                face_ok = false;
-                break;
+std::vector<Contact> &Scene::get_contacts(double lookahead)
+{
+    std::vector<Contact> &result = _contacts;
+    result.clear();
+
+    _find_pairs(lookahead);
+    auto &pairs = _pairs;
+
+    // pairs are independent: chunks of a cell are collided by the thread pool,
+    // each into a buffer of its own, the buffers are joined in chunk order, so
+    // the contacts come out in the same order as from a serial loop
+    struct Chunk {
+        unsigned cell;
+        std::size_t begin, end;
+    };
+    std::pmr::vector<Chunk> chunks(&_frame_arena);
+    for(unsigned cell = 0; cell < pairs.size(); cell++) {
+        for(std::size_t begin = 0; begin < pairs[cell].size(); begin += NARROW_PHASE_CHUNK)
+            chunks.push_back({cell, begin, std::min(begin + NARROW_PHASE_CHUNK, pairs[cell].size())});
+    }
+    if(_chunk_contacts.size() < chunks.size())
+        _chunk_contacts.resize(chunks.size());
+    _thread_pool.parallel_for(chunks.size(), [&](std::size_t i) {
+        const Chunk &chunk = chunks[i];
+        _chunk_contacts[i].clear();
+        const std::span<const std::pair<unsigned, unsigned>> chunk_pairs(pairs[chunk.cell]);
+        (this->*_collide_table[chunk.cell])(chunk_pairs.subspan(chunk.begin, chunk.end - chunk.begin),
+                                            lookahead, _chunk_contacts[i]);
+    });
+    for(std::size_t i = 0; i < chunks.size(); i++)
+        result.insert(result.end(), _chunk_contacts[i].begin(), _chunk_contacts[i].end());
+
+    return result;
+}
+
+void Scene::_find_pairs(double lookahead)
+{
+    // pairs grouped by their shapes, every group is handled by its own routine
+    for(auto &cell : _pairs)
+        cell.clear();
+
+    // bounds of the bodies grown by the distance they may move within
+    // lookahead and by CONTACT_EPSILON: pairs with bounds apart can get
+    // neither a contact nor a speculative one, so they skip the narrow phase
+    broad_phase::clear(_bounds);
+    for(const auto &cube : _cubes) {
+        const double margin = (glm::length(cube.get_velocity()) +
+                               glm::length(cube.get_angular_velocity()) * bounding_radius(cube)) * lookahead;
+        const glm::dvec3 half = bounding_half_extents(cube) + margin + CONTACT_EPSILON;
+        broad_phase::add(_bounds, cube.get_position() - half, cube.get_position() + half);
+    }
+
+    for(unsigned a = 0; a < _cubes.size(); a++) {
+        // other bodies, then planes, ascending
+        _candidates.clear();
+        broad_phase::overlapping(_bounds, a, _candidates);
+        const std::size_t cube_candidates = _candidates.size();
+        broad_phase::touching(_bounds, a, _plane_bounds, _candidates);
+        for(std::size_t i = cube_candidates; i < _candidates.size(); i++)
+            _candidates[i] += _cubes.size();
+
+        for(const unsigned b : _candidates) {
+            // sleeping bodies don't move, their contacts can't change (static ones neither)
+            if(!_is_awake(a) && !_is_awake(b))
+                continue;
+            const narrow_phase::Shape shape_a = _shape_of(a);
+            const narrow_phase::Shape shape_b = _shape_of(b);
+            const auto pair = (shape_a <= shape_b) ? std::make_pair(a, b) : std::make_pair(b, a);
+            _pairs[narrow_phase::cell(std::min(shape_a, shape_b), std::max(shape_a, shape_b))].push_back(pair);
+            // caches of all pairs exist before the parallel part, which only looks them up
+            _pair_cache.try_emplace(pair).first->second.candidate = true;
+        }
+    }
+}
+
+bool Scene::_get_speculative_contact(unsigned a, unsigned b, double lookahead, std::vector<Contact> &result)
+{
+    // slow pairs are caught by regular contacts in time
+    const double reach = approach_bound(_cubes[a], _cubes[b], lookahead);
+    if(reach <= CONTACT_EPSILON || gap_bound(_cubes[a], _cubes[b]) > reach)
+        return false;
+
+    PairCache &cache = _pair_cache.at(std::make_pair(a, b));
+    const gjk::Result gjk_result = gjk::distance(CubeSupport{_cubes[a], cache.support_hints[0]},
+                                                 CubeSupport{_cubes[b], cache.support_hints[1]}, cache.simplex);
+    if(gjk_result.intersecting || gjk_result.distance > reach)
+        return false;
+
+    // the solver lets the bodies approach by the gap during the next step, but not further
+    const glm::dvec3 contact_point = (gjk_result.point_a + gjk_result.point_b) / 2.0;
+    result.emplace_back(a, b, contact_point, gjk_result.normal, 0.0, FEATURE_SPECULATIVE);
+    result.back().gap = gjk_result.distance;
+    return true;
+}
+
+template<narrow_phase::Shape A, narrow_phase::Shape B>
+void Scene::_collide(std::span<const std::pair<unsigned, unsigned>>, double, std::vector<Contact> &)
+{
+}
+
+template<>
+void Scene::_collide<narrow_phase::Shape::BOX, narrow_phase::Shape::BOX>(
+    std::span<const std::pair<unsigned, unsigned>> pairs, double lookahead, std::vector<Contact> &result)
+{
+    for(const auto &[a, b] : pairs) {
+        const std::size_t first_contact = result.size();
+        _get_pair_contacts(a, b, result);
+        if(result.size() == first_contact && lookahead > 0.0)
+            _get_speculative_contact(a, b, lookahead, result);
+    }
+}
+
+template<>
+void Scene::_collide<narrow_phase::Shape::BOX, narrow_phase::Shape::PLANE>(
+    std::span<const std::pair<unsigned, unsigned>> pairs, double lookahead, std::vector<Contact> &result)
+{
+    for(const auto &[a, b] : pairs)
+        _get_plane_contacts(a, b - _cubes.size(), lookahead, result);
+}
+
+template<>
+void Scene::_collide<narrow_phase::Shape::BOX, narrow_phase::Shape::HULL>(
+    std::span<const std::pair<unsigned, unsigned>> pairs, double lookahead, std::vector<Contact> &result)
+{
+    for(const auto &[a, b] : pairs)
+        _get_convex_contact(a, b, lookahead, result);
+}
+
+template<>
+void Scene::_collide<narrow_phase::Shape::HULL, narrow_phase::Shape::HULL>(
+    std::span<const std::pair<unsigned, unsigned>> pairs, double lookahead, std::vector<Contact> &result)
+{
+    for(const auto &[a, b] : pairs)
+        _get_convex_contact(a, b, lookahead, result);
+}
+
+template<>
+void Scene::_collide<narrow_phase::Shape::HULL, narrow_phase::Shape::PLANE>(
+    std::span<const std::pair<unsigned, unsigned>> pairs, double lookahead, std::vector<Contact> &result)
+{
+    for(const auto &[a, b] : pairs)
+        _get_hull_plane_contacts(a, b - _cubes.size(), lookahead, result);
+}
+
+const std::array<Scene::CollideFunction, narrow_phase::CELL_COUNT> Scene::_collide_table =
+    narrow_phase::make_table<Scene::CollideFunction, Scene::_CollideCell>();
+
+narrow_phase::Shape Scene::_shape_of(unsigned body) const
+{
+    if(_is_static(body))
+        return narrow_phase::Shape::PLANE;
+    return _cubes[body].get_hull() ? narrow_phase::Shape::HULL : narrow_phase::Shape::BOX;
+}
+
+void Scene::_get_convex_contact(unsigned a, unsigned b, double lookahead, std::vector<Contact> &result)
+{
+    PairCache &cache = _pair_cache.at(std::make_pair(a, b));
+    const std::size_t first_contact = result.size();
+
+    const gjk::Result gjk_result = gjk::collide(CubeSupport{_cubes[a], cache.support_hints[0]},
+                                                CubeSupport{_cubes[b], cache.support_hints[1]}, cache.simplex);
+    if(gjk_result.intersecting || gjk_result.distance <= CONTACT_EPSILON) {
+        const glm::dvec3 contact_point = (gjk_result.point_a + gjk_result.point_b) / 2.0;
+        result.emplace_back(a, b, contact_point, gjk_result.normal, gjk_result.depth, FEATURE_EPA);
+    } else if(lookahead > 0.0) {
+        _get_speculative_contact(a, b, lookahead, result);
+    }
+    _match_manifold(cache, result, first_contact);
+}
+
+void Scene::_get_hull_plane_contacts(unsigned a, unsigned p, double lookahead, std::vector<Contact> &result)
+{
+    const Cube &body = _cubes[a];
+    const hull::Hull &shape = *body.get_hull();
+    const Plane &plane = _planes[p];
+    const unsigned b = _cubes.size() + p;
+    const glm::dvec3 normal = plane.get_normal();
+
+    // distance the body may move towards the plane within lookahead
+    const double reach = approach_bound(body, plane, lookahead);
+    const double center = glm::dot(normal, body.get_position() - plane.get_point());
+    if(center - bounding_radius(body) > std::max(reach, CONTACT_EPSILON))
+        return;
+
+    const glm::dmat3x3 rotation = glm::mat3_cast(body.get_orientation());
+    auto world = [&](unsigned vertex) { return body.get_position() + rotation * shape.vertices()[vertex]; };
+    auto distance = [&](unsigned vertex) { return glm::dot(normal, world(vertex) - plane.get_point()); };
+
+    PairCache &cache = _pair_cache.at(std::make_pair(a, b));
+    const unsigned deepest = body.get_hull_support(-normal, cache.support_hints[0]);
+    if(distance(deepest) > std::max(reach, CONTACT_EPSILON))
+        return;
+    const std::size_t first_contact = result.size();
+
+    // vertices within CONTACT_EPSILON form a connected part of the hull
+    // around the deepest one, the rest of the hull is never visited
+    std::pmr::vector<std::pair<double, unsigned>> close(&_frame_arena); // (distance, vertex)
+    std::pmr::vector<unsigned> stack({deepest}, &_frame_arena);
+    // one bit per hull vertex, cleared in a pass over words, not vertices
+    std::pmr::vector<bool> visited(shape.vertices().size(), false, &_frame_arena);
+    visited[deepest] = true;
+    while(!stack.empty()) {
+        const unsigned vertex = stack.back();
+        stack.pop_back();
+        const double d = distance(vertex);
+        if(d > CONTACT_EPSILON)
+            continue;
+        close.emplace_back(d, vertex);
+        for(const unsigned neighbor : shape.neighbors()[vertex]) {
+            if(!visited[neighbor]) {
+                visited[neighbor] = true;
+                stack.push_back(neighbor);
             }
         }
+    }
 
-        if(face_ok) {
-            curr_sep_planes.emplace_back(face, false);
+    // the deepest MAX_POLYGON_POINTS of them, reduced to a manifold
+    std::sort(close.begin(), close.end());
+    manifold::Polygon points;
+    std::array<double, MAX_POLYGON_POINTS> depths;
+    for(const auto &[d, vertex] : close) {
+        if(points.size == MAX_POLYGON_POINTS)
             break;
+        const glm::dvec3 point = world(vertex);
+        if(!plane.contains(point))
+            continue;
+        depths[points.size] = -d;
+        points.features[points.size] = vertex;
+        // contact point lies halfway between the vertex and the plane
+        points.points[points.size++] = point - normal * (d / 2.0);
+    }
+
+    if(points.size > 0) {
+        std::array<unsigned, MAX_MANIFOLD_POINTS> selected;
+        const unsigned count = manifold::reduce(points, depths, normal, selected);
+        for(unsigned i = 0; i < count; i++) {
+            result.emplace_back(a, b, points.points[selected[i]], normal,
+                                std::max(depths[selected[i]], 0.0), FEATURE_FACE | points.features[selected[i]]);
         }
+    } else if(close.empty() && lookahead > 0.0 && plane.contains(world(deepest))) {
+        // the deepest vertex may reach the plane during the step
+        const double gap = distance(deepest);
+        result.emplace_back(a, b, world(deepest) - normal * (gap / 2.0), normal, 0.0, FEATURE_SPECULATIVE);
+        result.back().gap = gap;
     }
+    _match_manifold(cache, result, first_contact);
+}
 
-    static std::size_t count = 0;
-    double KE0 = _cubes[0].get_kinetic_energy();
-    double KE1 = _cubes[1].get_kinetic_energy();
-    std::cout << "c=" << count++ << "; found=" << curr_sep_planes.size() << "; KE0=" <<
-                 KE0 << "; KE1=" << KE1 << "; KE_sum=" << KE0 + KE1 << std::endl;
-     // << "; plane=(" <<
-     //             separating_face.x << ", " << separating_face.y << ", " <<
-     //             separating_face.z << ", " << separating_face.w << "); " << 
-     //             "cube0=" << separating_face_from_cube0 << std::endl;
-     
-    // if separation plane(s) found there's nothing more to do
-    if(!curr_sep_planes.empty()) {
-        prev_sep_planes = curr_sep_planes;
-        return result;
+void Scene::_get_plane_contacts(unsigned a, unsigned p, double lookahead, std::vector<Contact> &result)
+{
+    const Cube &cube = _cubes[a];
+    const Plane &plane = _planes[p];
+    const unsigned b = _cubes.size() + p;
+    const glm::dvec3 normal = plane.get_normal();
+
+    // distance the cube may move towards the plane within lookahead
+    const double reach = approach_bound(cube, plane, lookahead);
+    const double center = glm::dot(normal, cube.get_position() - plane.get_point());
+    if(center - bounding_radius(cube) > std::max(reach, CONTACT_EPSILON))
+        return;
+
+    const auto vertices = cube.get_vertices();
+    double distance[CLASSIFY_VERTICES];
+    if(classify::outside(plane.get_plane(), vertices, std::max(reach, CONTACT_EPSILON), distance) == classify::ALL_OUTSIDE)
+        return;
+
+    PairCache &cache = _pair_cache.at(std::make_pair(a, b));
+    const std::size_t first_contact = result.size();
+
+    // vertices behind the plane or within CONTACT_EPSILON in front of it
+    static_assert(CLASSIFY_VERTICES <= MAX_POLYGON_POINTS, "every vertex of the box fits into the polygon");
+    manifold::Polygon points;
+    std::array<double, MAX_POLYGON_POINTS> depths;
+    unsigned closest = CLASSIFY_VERTICES;
+    for(unsigned v = 0; v < CLASSIFY_VERTICES; v++) {
+        if(!plane.contains(vertices[v]))
+            continue;
+        if(closest == CLASSIFY_VERTICES || distance[v] < distance[closest])
+            closest = v;
+        if(distance[v] > CONTACT_EPSILON)
+            continue;
+        depths[points.size] = -distance[v];
+        points.features[points.size] = v;
+        // contact point lies halfway between the vertex and the plane
+        points.points[points.size++] = vertices[v] - normal * (distance[v] / 2.0);
     }
 
+    if(points.size > 0) {
+        std::array<unsigned, MAX_MANIFOLD_POINTS> selected;
+        const unsigned count = manifold::reduce(points, depths, normal, selected);
+        for(unsigned i = 0; i < count; i++) {
+            result.emplace_back(a, b, points.points[selected[i]], normal,
+                                std::max(depths[selected[i]], 0.0), FEATURE_FACE | points.features[selected[i]]);
+        }
+    } else if(closest != CLASSIFY_VERTICES && lookahead > 0.0 && distance[closest] <= reach) {
+        // the closest vertex may reach the plane during the step
+        result.emplace_back(a, b, vertices[closest] - normal * (distance[closest] / 2.0), normal,
+                            0.0, FEATURE_SPECULATIVE);
+        result.back().gap = distance[closest];
+    }
+    _match_manifold(cache, result, first_contact);
+}
 
-    // Step 2. Check last separating plane for vertex to face contacts
-    // search for vertex to plane contacts
-    for(const auto &plane : prev_sep_planes) {
-        const glm::dvec3 normal = glm::dvec3(plane.plane.x, plane.plane.y, plane.plane.z);
-        double D = plane.plane.w * -1.0;
-        
-        const auto &vertices_to_check = (plane.from_cube_0) ? vertices1 : vertices0;
-        const auto &plane_cube = (plane.from_cube_0) ? _cubes[0] : _cubes[1];
-        const auto &vertex_cube = (plane.from_cube_0) ? _cubes[1] : _cubes[0];
-        const unsigned body_a = (plane.from_cube_0) ? 1 : 0;
-        const unsigned body_b = (plane.from_cube_0) ? 0 : 1;
-        
-        for(const auto &vertex : vertices_to_check) {
-            double dot_product = glm::dot(normal, vertex);
-            if(solver::check_value_equal(dot_product, D, CONTACT_EPSILON) &&
-               plane_cube.check_point_on_surface(vertex)) {
-                // contact found
-
-                // check normal direction
-                // normal vector should be pointing towards body A
-                double tmp = glm::dot(normal, vertex_cube.get_position() - vertex);
-                result.emplace_back(body_a, body_b, vertex, (tmp <= 0) ? -normal : normal);
-            }
-            else if(solver::check_value_less(dot_product, D, CONTACT_EPSILON)) {
-                std::cerr << "Penetration detected!" << std::endl;
-                throw;
-            }
+bool Scene::_check_sep_plane(const SepPlane &plane, const std::array<glm::dvec4, 6> &faces,
+                             const std::array<glm::dvec3, 8> &vertices) const
+{
+    // every vertex of the other cube must be on the outer side of the face
+    return classify::outside(faces[plane.face], vertices, CONTACT_EPSILON) == classify::ALL_OUTSIDE;
+}
+
+void Scene::_get_pair_contacts(unsigned a, unsigned b, std::vector<Contact> &result)
+{
+    const Cube &cube_a = _cubes[a];
+    const Cube &cube_b = _cubes[b];
+    PairCache &cache = _pair_cache.at(std::make_pair(a, b));
+
+    auto faces_a = cube_a.get_faces();
+    auto faces_b = cube_b.get_faces();
+
+    auto vertices_a = cube_a.get_vertices();
+    auto vertices_b = cube_b.get_vertices();
+
+    // Step 0. Try whatever separated the pair last frame, most pairs exit here
+    if(cache.sep_planes_count > 0) {
+        const SepPlane &plane = cache.sep_planes[0];
+        if(_check_sep_plane(plane, plane.from_body_a ? faces_a : faces_b,
+                                   plane.from_body_a ? vertices_b : vertices_a))
+            return;
+    }
+    if(cache.sep_axis_valid) {
+        // project both cubes onto the axis (it points from B towards A)
+        const double gap = glm::dot(cube_a.support(-cache.sep_axis) - cube_b.support(cache.sep_axis),
+                                    cache.sep_axis);
+        if(gap > CONTACT_EPSILON)
+            return;
+    }
+
+    // check for vertex to face contacts first
+    // Step 1. Search for separating plane
+    std::array<SepPlane, 2> curr_sep_planes;
+    unsigned curr_sep_planes_count = 0;
+
+    // all vertices of each cube against all faces of the other one
+    classify::Result faces_a_vertices_b, faces_b_vertices_a;
+    classify::classify(faces_a, vertices_b, CONTACT_EPSILON, faces_a_vertices_b);
+    classify::classify(faces_b, vertices_a, CONTACT_EPSILON, faces_b_vertices_a);
+
+    for(unsigned i = 0; i < faces_a.size(); i++) {
+        if(faces_a_vertices_b.outside[i] == classify::ALL_OUTSIDE) {
+            curr_sep_planes[curr_sep_planes_count++] = {i, true};
+            break;
         }
     }
-    
+
+    // search for another vector of faces
+    for(unsigned i = 0; i < faces_b.size(); i++) {
+        if(faces_b_vertices_a.outside[i] == classify::ALL_OUTSIDE) {
+            curr_sep_planes[curr_sep_planes_count++] = {i, false};
+            break;
+        }
+    }
+
+    // if separation plane(s) found there's nothing more to do
+    if(curr_sep_planes_count > 0) {
+        cache.sep_planes = curr_sep_planes;
+        cache.sep_planes_count = curr_sep_planes_count;
+        cache.sep_axis_valid = false;
+        return;
+    }
+
+    // Step 1.5. No face separates the cubes, but they still may be apart
+    // (e.g. separated along an edge-edge axis). GJK gives the exact distance,
+    // EPA gives depth and normal if they overlap.
+    const gjk::Result gjk_result = gjk::collide(cube_a, cube_b, cache.simplex);
+    if(!gjk_result.intersecting && gjk_result.distance > CONTACT_EPSILON) {
+        cache.sep_axis = gjk_result.normal;
+        cache.sep_axis_valid = true;
+        return;
+    }
+    cache.sep_axis_valid = false;
+    const std::size_t first_contact = result.size();
+
+    // Step 2. Face contact: clip the incident face against the reference face,
+    // an edge-edge contact is searched only if there is none
+    if(_get_face_contacts(a, b, faces_a, faces_b, vertices_a, vertices_b, gjk_result.normal, result) > 0) {
+        _match_manifold(cache, result, first_contact);
+        return;
+    }
+
     // Step 3. Check for edge-edge contacts
     // 0---1  4---5
     // | U |  | D |
     // 2---3  6---7
-    std::array<std::pair<glm::dvec3, glm::dvec3>, 12> edges0 = {
-        std::make_pair(vertices0[0], vertices0[1]),
-        std::make_pair(vertices0[1], vertices0[3]),
-        std::make_pair(vertices0[3], vertices0[2]),
-        std::make_pair(vertices0[2], vertices0[0]),
-
-        std::make_pair(vertices0[0], vertices0[4]),
-        std::make_pair(vertices0[1], vertices0[5]),
-        std::make_pair(vertices0[2], vertices0[6]),
-        std::make_pair(vertices0[3], vertices0[7]),
-
-        std::make_pair(vertices0[4], vertices0[5]),
-        std::make_pair(vertices0[5], vertices0[7]),
-        std::make_pair(vertices0[7], vertices0[6]),
-        std::make_pair(vertices0[6], vertices0[4])
+    std::array<std::pair<glm::dvec3, glm::dvec3>, 12> edges_a = {
+        std::make_pair(vertices_a[0], vertices_a[1]),
+        std::make_pair(vertices_a[1], vertices_a[3]),
+        std::make_pair(vertices_a[3], vertices_a[2]),
+        std::make_pair(vertices_a[2], vertices_a[0]),
+
+        std::make_pair(vertices_a[0], vertices_a[4]),
+        std::make_pair(vertices_a[1], vertices_a[5]),
+        std::make_pair(vertices_a[2], vertices_a[6]),
+        std::make_pair(vertices_a[3], vertices_a[7]),
+
+        std::make_pair(vertices_a[4], vertices_a[5]),
+        std::make_pair(vertices_a[5], vertices_a[7]),
+        std::make_pair(vertices_a[7], vertices_a[6]),
+        std::make_pair(vertices_a[6], vertices_a[4])
     };
-    std::array<std::pair<glm::dvec3, glm::dvec3>, 12> edges1 = {
-        std::make_pair(vertices1[0], vertices1[1]),
-        std::make_pair(vertices1[1], vertices1[3]),
-        std::make_pair(vertices1[3], vertices1[2]),
-        std::make_pair(vertices1[2], vertices1[0]),
-
-        std::make_pair(vertices1[0], vertices1[4]),
-        std::make_pair(vertices1[1], vertices1[5]),
-        std::make_pair(vertices1[2], vertices1[6]),
-        std::make_pair(vertices1[3], vertices1[7]),
-
-        std::make_pair(vertices1[4], vertices1[5]),
-        std::make_pair(vertices1[5], vertices1[7]),
-        std::make_pair(vertices1[7], vertices1[6]),
-        std::make_pair(vertices1[6], vertices1[4])
+    std::array<std::pair<glm::dvec3, glm::dvec3>, 12> edges_b = {
+        std::make_pair(vertices_b[0], vertices_b[1]),
+        std::make_pair(vertices_b[1], vertices_b[3]),
+        std::make_pair(vertices_b[3], vertices_b[2]),
+        std::make_pair(vertices_b[2], vertices_b[0]),
+
+        std::make_pair(vertices_b[0], vertices_b[4]),
+        std::make_pair(vertices_b[1], vertices_b[5]),
+        std::make_pair(vertices_b[2], vertices_b[6]),
+        std::make_pair(vertices_b[3], vertices_b[7]),
+
+        std::make_pair(vertices_b[4], vertices_b[5]),
+        std::make_pair(vertices_b[5], vertices_b[7]),
+        std::make_pair(vertices_b[7], vertices_b[6]),
+        std::make_pair(vertices_b[6], vertices_b[4])
     };
 
-    for(const auto &edge0 : edges0) {
-        // std::cout << "Edge 0 next" << std::endl;
-        // std::cout << "--------------------------------------------" << std::endl;
-        for(const auto &edge1 : edges1) {
-            const glm::dvec3 n0 = (edge0.second - edge0.first);
-            const glm::dvec3 n1 = (edge1.second - edge1.first);
-            const glm::dvec3 ndiff = (edge1.first - edge0.first);
+    // closest points of every pair of edges, SEGMENT_LANES edges of B at once
+    static_assert(std::tuple_size<decltype(edges_b)>::value % SEGMENT_LANES == 0, "edges of B fill whole batches");
+    segment::Batch batch;
+    for(unsigned edge_a = 0; edge_a < edges_a.size(); edge_a++) {
+        const glm::dvec3 n0 = edges_a[edge_a].second - edges_a[edge_a].first;
+        for(unsigned first_b = 0; first_b < edges_b.size(); first_b += SEGMENT_LANES) {
+            for(unsigned l = 0; l < SEGMENT_LANES; l++) {
+                const auto &edge1 = edges_b[first_b + l];
+                for(unsigned k = 0; k < 3; k++) {
+                    batch.start_a[k][l] = edges_a[edge_a].first[k];
+                    batch.dir_a[k][l] = n0[k];
+                    batch.start_b[k][l] = edge1.first[k];
+                    batch.dir_b[k][l] = edge1.second[k] - edge1.first[k];
+                }
+            }
+            segment::closest_points(batch);
 
-            const double triple_product = glm::dot(n0, glm::cross(n1, ndiff));
-            if(std::abs(triple_product) <= COMPLANARITY_EPSILON)
-                continue;
+            for(unsigned l = 0; l < SEGMENT_LANES; l++) {
+                if(batch.distance2[l] > CONTACT_EPSILON * CONTACT_EPSILON)
+                    continue;
+                const unsigned edge_b = first_b + l;
+                const auto &edge0 = edges_a[edge_a];
+                const auto &edge1 = edges_b[edge_b];
+                const glm::dvec3 n1 = edge1.second - edge1.first;
 
-            const glm::dvec3 cross_product = glm::cross(n0, n1);
-
-            const double dist = std::abs(triple_product) / std::abs(glm::length(cross_product));
-            if(dist <= CONTACT_EPSILON) {
-                // std::cout << "M0: (" << edge0.first.x << "; " << edge0.first.y << "; " << edge0.first.z << ")" << std::endl;
-                // std::cout << "M0e: (" << edge0.second.x << "; " << edge0.second.y << "; " << edge0.second.z << ")" << std::endl;
-                // std::cout << "M1: (" << edge1.first.x << "; " << edge1.first.y << "; " << edge1.first.z << ")" << std::endl;
-                // std::cout << "n0: (" << n0.x << "; " << n0.y << "; " << n0.z << ")" << std::endl;
-                // std::cout << "n1: (" << n1.x << "; " << n1.y << "; " << n1.z << ")" << std::endl;
-                // std::cout << dist << std::endl;
-                // std::cout << "dist ok" << std::endl;
-                // std::cout << "Diff: (" << ndiff.x << "; " << ndiff.y << "; " << ndiff.z << ")" << std::endl;
-            
-                // std::cout << triple_product << std::endl;
-                // find perpendicular to this edges - it's middle point will be a contact point
-                // from parametric line equation: (h1/h2 are common points of perpendicular and edge0/edge1)
-                // h1 = (n0.x * t + edge0.first.x; n0.y * t + edge0.first.y; n0.z * t + edge0.first.z)
-                // h2 = (n1.x * s + edge1.first.x; n1.y * s + edge1.first.y; n1.z * s + edge1.first.z)
-                // h1h2 = h2 - h1
-                // 
-                // geometrically cross_product is perpendicular to both of the edges, so it's a normal of perpendicular line
-                // lambda = cross_product
-                
-                // let's define system of linear equations in matrix form
-                //   t  s  lambda C
-                // x
-                // y
-                // z
-
-                glm::dmat3x4 h1h2 = {-n0.x, n1.x, -cross_product.x, edge0.first.x - edge1.first.x,
-                                     -n0.y, n1.y, -cross_product.y, edge0.first.y - edge1.first.y,
-                                     -n0.z, n1.z, -cross_product.z, edge0.first.z - edge1.first.z};
-                                                                  
-                solver::reduce_to_RREF(h1h2);
-
-                const double t = h1h2[0][3];
-                const double s = h1h2[1][3];
-                
-                const glm::dvec3 h1 = {n0.x * t + edge0.first.x, n0.y * t + edge0.first.y, n0.z * t + edge0.first.z};
-                const glm::dvec3 h2 = {n1.x * s + edge1.first.x, n1.y * s + edge1.first.y, n1.z * s + edge1.first.z};
-
-                // std::cout << "checks: " << _cubes[0].check_point_on_edge(h1) << "; " << _cubes[1].check_point_on_edge(h2) << std::endl;
-                const bool checks_done = _cubes[0].check_point_on_edge(h1) && _cubes[1].check_point_on_edge(h2);
-                if(!checks_done)
+                // parallel or coplanar edges touch along a segment or at a vertex,
+                // face contacts take care of those
+                const double triple_product = glm::dot(n0, glm::cross(n1, edge1.first - edge0.first));
+                if(std::abs(triple_product) <= COMPLANARITY_EPSILON)
                     continue;
 
-                const glm::dvec3 contact_point = (h1+h2) / 2.0;
-                // std::cout << "Edge contact, ";
-                // std::cout << "Point(a): (" << contact_point.x << "; " << contact_point.y << "; " << contact_point.z << ")" << std::endl;
-                // std::cout << "Point(1): (" << h1.x << "; " << h1.y << "; " << h1.z << ")" << std::endl;
-                // std::cout << "Point(2): (" << h2.x << "; " << h2.y << "; " << h2.z << ")" << std::endl;
-                // std::cout << std::endl;
+                // middle of the common perpendicular of the edges
+                const glm::dvec3 h1 = edge0.first + n0 * batch.s[l];
+                const glm::dvec3 h2 = edge1.first + n1 * batch.t[l];
+                const glm::dvec3 contact_point = (h1 + h2) / 2.0;
 
                 // normal vector should be pointing towards body A
                 glm::dvec3 normal = glm::cross(n0, n1);
-                double tmp = glm::dot(normal, _cubes[0].get_position() - contact_point);
+                double tmp = glm::dot(normal, cube_a.get_position() - contact_point);
                 if(tmp <= 0)
                     normal = -normal;
-                result.emplace_back(0, 1, contact_point, n0, n1, normal);
+                result.emplace_back(a, b, contact_point, n0, n1, normal, FEATURE_EDGE | (edge_a << 8) | edge_b);
             }
         }
     }
 
-    
-    std::cout << "Total contacts: " << result.size() << std::endl;
+    // Step 4. Shapes overlap, but no vertex/face or edge/edge feature matched:
+    // fall back to the single EPA contact
+    if(result.size() == first_contact && gjk_result.intersecting) {
+        const glm::dvec3 contact_point = (gjk_result.point_a + gjk_result.point_b) / 2.0;
+        result.emplace_back(a, b, contact_point, gjk_result.normal, gjk_result.depth, FEATURE_EPA);
+    }
+    _match_manifold(cache, result, first_contact);
+}
+
+unsigned Scene::_get_face_contacts(unsigned a, unsigned b,
+                                   const std::array<glm::dvec4, 6> &faces_a, const std::array<glm::dvec4, 6> &faces_b,
+                                   const std::array<glm::dvec3, 8> &vertices_a, const std::array<glm::dvec3, 8> &vertices_b,
+                                   const glm::dvec3 &normal, std::vector<Contact> &result) const
+{
+    auto face_normal = [](const glm::dvec4 &face) { return glm::dvec3(face.x, face.y, face.z); };
+
+    // reference face candidates: face of B looking along the normal or face of A looking against it
+    unsigned ref_a = 0, ref_b = 0;
+    for(unsigned i = 1; i < faces_a.size(); i++) {
+        if(glm::dot(face_normal(faces_a[i]), -normal) > glm::dot(face_normal(faces_a[ref_a]), -normal))
+            ref_a = i;
+        if(glm::dot(face_normal(faces_b[i]), normal) > glm::dot(face_normal(faces_b[ref_b]), normal))
+            ref_b = i;
+    }
+    const double align_a = glm::dot(face_normal(faces_a[ref_a]), -normal);
+    const double align_b = glm::dot(face_normal(faces_b[ref_b]), normal);
+
+    // normal is far from any face normal: edge-edge contact
+    if(std::max(align_a, align_b) < FACE_CONTACT_ALIGNMENT)
+        return 0;
+
+    // prefer B a little, so the reference face doesn't flip between frames
+    const bool ref_is_b = align_b + REFERENCE_FACE_BIAS >= align_a;
+    const auto &ref_faces    = ref_is_b ? faces_b : faces_a;
+    const auto &inc_faces    = ref_is_b ? faces_a : faces_b;
+    const auto &inc_vertices = ref_is_b ? vertices_a : vertices_b;
+    const unsigned ref_face  = ref_is_b ? ref_b : ref_a;
+    const glm::dvec3 ref_normal = face_normal(ref_faces[ref_face]);
+
+    // incident face is the most anti-parallel to the reference one
+    unsigned inc_face = 0;
+    for(unsigned i = 1; i < inc_faces.size(); i++) {
+        if(glm::dot(face_normal(inc_faces[i]), ref_normal) < glm::dot(face_normal(inc_faces[inc_face]), ref_normal))
+            inc_face = i;
+    }
+
+    manifold::Polygon polygon;
+    for(const unsigned vertex : Cube::face_vertices[inc_face]) {
+        polygon.points[polygon.size] = inc_vertices[vertex];
+        polygon.features[polygon.size++] = vertex;
+    }
+
+    // clip by the side faces of the reference cube
+    for(unsigned i = 0; i < ref_faces.size(); i++) {
+        // skip the reference face itself and the opposite one
+        if(std::abs(glm::dot(face_normal(ref_faces[i]), ref_normal)) > 0.5)
+            continue;
+        polygon = manifold::clip(polygon, ref_faces[i], i);
+    }
+
+    // keep points below (or within CONTACT_EPSILON above) the reference face
+    manifold::Polygon points;
+    std::array<double, MAX_POLYGON_POINTS> depths;
+    for(unsigned i = 0; i < polygon.size; i++) {
+        const double separation = glm::dot(ref_normal, polygon.points[i]) + ref_faces[ref_face].w;
+        if(separation > CONTACT_EPSILON)
+            continue;
+        // deeper points are kept too, position correction pushes them out
+        depths[points.size] = -separation;
+        points.features[points.size] = polygon.features[i];
+        // contact point lies halfway between the incident point and the reference face
+        points.points[points.size++] = polygon.points[i] - ref_normal * (separation / 2.0);
+    }
+
+    std::array<unsigned, MAX_MANIFOLD_POINTS> selected;
+    const unsigned count = manifold::reduce(points, depths, ref_normal, selected);
+
+    // normal vector should be pointing towards body A
+    const glm::dvec3 contact_normal = ref_is_b ? ref_normal : -ref_normal;
+    const unsigned faces_feature = FEATURE_FACE | (ref_is_b << 28) | (ref_face << 20) | (inc_face << 12);
+    for(unsigned i = 0; i < count; i++) {
+        result.emplace_back(a, b, points.points[selected[i]], contact_normal,
+                            std::max(depths[selected[i]], 0.0), faces_feature | points.features[selected[i]]);
+    }
+
+    return count;
+}
+
+bool Scene::_is_static(unsigned body) const
+{
+    return body >= _cubes.size();
+}
+
+bool Scene::_is_awake(unsigned body) const
+{
+    return !_is_static(body) && _cubes[body].is_awake();
+}
+
+PhysicsBackend Scene::get_backend() const
+{
+    return _backend;
+}
+
+double Scene::get_kinetic_energy() const
+{
+    double result = 0.0;
+    for(const auto &cube : _cubes)
+        result += cube.get_kinetic_energy();
     return result;
 }
 
@@ -379,22 +1322,41 @@ glm::mat4 Scene::get_camera_transform() const
     return _camera->get_transform();
 }
 
-std::vector<glm::mat4> Scene::get_cubes_transform() const
+const std::vector<glm::mat4> &Scene::get_cubes_transform() const
 {
-    std::vector<glm::mat4> result;
+    _transforms.clear();
     for(const auto &i : _cubes) {
-        result.push_back(i.get_transform());
+        _transforms.push_back(i.get_transform());
+    }
+    for(const auto &i : _planes) {
+        _transforms.push_back(i.get_transform());
     }
 
-    return result;
+    return _transforms;
 }
 
-std::vector<unsigned> Scene::get_cube_meshes() const
+const std::vector<unsigned> &Scene::get_mesh_vertex_counts() const
 {
-    std::vector<unsigned> result;
+    _vertex_counts.clear();
     for(const auto &i : _cubes) {
-        result.push_back(i.get_cube_mesh());
+        _vertex_counts.push_back(i.get_mesh_vertex_count());
+    }
+    for(const auto &i : _planes) {
+        _vertex_counts.push_back(i.get_mesh_vertex_count());
     }
 
-    return result;
+    return _vertex_counts;
+}
+
+const std::vector<unsigned> &Scene::get_cube_meshes() const
+{
+    _meshes.clear();
+    for(const auto &i : _cubes) {
+        _meshes.push_back(i.get_cube_mesh());
+    }
+    for(const auto &i : _planes) {
+        _meshes.push_back(i.get_cube_mesh());
+    }
+
+    return _meshes;
 }
@@ -2,13 +2,27 @@
 #include <functional>
 #include <glm/glm.hpp>
 #include <glm/ext/scalar_constants.hpp>
+#include <span>
 #include <vector>
 #include <deque>
+#include <map>
+#include <cstdint>
 #include "camera.h"
 #include "cube.h"
+#include "plane.h"
+#include "../compute/gjk.h"
+#include "../compute/solver.h"
+#include "../compute/islands.h"
+#include "../compute/thread_pool.h"
+#include "../compute/xpbd.h"
+#include "../compute/narrow_phase.h"
+#include "../compute/arena.h"
+#include "../compute/broad_phase.h"
 
 
 #define ELASTIC
+#define USE_CCD                  // cut the frame at times of impact of fast pairs
+#define USE_SPECULATIVE_CONTACTS // contacts for fast pairs that are not touching yet
 // #define USE_EULER
 // #define USE_RK4
 #define USE_RK5
@@ -18,46 +32,220 @@
 #define CONTACT_EPSILON 0.05
 #define COMPLANARITY_EPSILON 0.00001
 #define MIN_COLLISION_SPEED 0.01
+#define FACE_CONTACT_ALIGNMENT 0.7 // min cos between contact normal and reference face normal
+#define REFERENCE_FACE_BIAS 0.01
+#define MANIFOLD_MATCH_DISTANCE 0.02 // max drift of a contact point between frames to keep its impulse
+#define PENETRATION_SLOP 0.01 // penetration left uncorrected, keeps resting contacts alive
+#define POSITION_CORRECTION 0.2 // part of the penetration removed per step (Baumgarte factor)
+#define GRAVITY glm::dvec3(0.0, 0.0, 0.0) // external acceleration of every body
+#define SLEEP_LINEAR_VELOCITY  0.01 // bodies slower than that for TIME_TO_SLEEP fall asleep
+#define SLEEP_ANGULAR_VELOCITY 0.02
+#define TIME_TO_SLEEP 0.5
+#define ISLAND_BATCH_COST 64 // contacts per solver task, smaller islands are batched together
+#define COLORED_ISLAND_CONTACTS 256 // larger islands are solved in color batches by all threads
+#define NARROW_PHASE_CHUNK 16 // candidate pairs per narrow phase task
+#define REORDER_INTERVAL 60 // frames between reorderings of the bodies by position (0 = never)
+#define CCD_MAX_SUBSTEPS 8 // frame is cut at most that many times at times of impact and events
+
+#ifdef ELASTIC
+#define RESTITUTION 1.0
+#else
+#define RESTITUTION 0.0
+#endif
 
 
 struct Contact {
-    unsigned body_a, body_b;
+    unsigned body_a, body_b; // body_b >= cube count: static plane (body_b - cube count)
     glm::dvec3 point;
     glm::dvec3 normal; // normal of face pointing outwards (towards body A)
     glm::dvec3 edge_a, edge_b; // contacting edges
     bool vertex_to_face;  // true=vertex/face, false=edge/edge
+    double depth = 0.0;   // penetration depth (EPA), 0 for features found within CONTACT_EPSILON
+    double gap = 0.0;     // speculative contacts: distance the bodies may still close during the step
+    unsigned feature = 0; // id of the features that produced the contact, stable between frames
+
+    // accumulated normal impulse, kept between frames to warm-start the next solve
+    double normal_impulse = 0.0;
+    // resting contact force, kept between frames to warm-start the LCP solve
+    double normal_force = 0.0;
 
     // vertex-face contact constructor
-    Contact(unsigned body_a, unsigned body_b, glm::dvec3 point, glm::dvec3 normal) :
-        body_a{body_a}, body_b{body_b}, point{point}, normal{normal}, vertex_to_face{true} {}
+    Contact(unsigned body_a, unsigned body_b, glm::dvec3 point, glm::dvec3 normal,
+            double depth = 0.0, unsigned feature = 0) :
+        body_a{body_a}, body_b{body_b}, point{point}, normal{normal}, vertex_to_face{true},
+        depth{depth}, feature{feature} {}
 
     // edge-edge contact constructor
     Contact(unsigned body_a, unsigned body_b, glm::dvec3 point,
-            glm::dvec3 edge_a, glm::dvec3 edge_b, glm::dvec3 normal) :
+            glm::dvec3 edge_a, glm::dvec3 edge_b, glm::dvec3 normal, unsigned feature = 0) :
         body_a{body_a}, body_b{body_b}, point{point}, edge_a{edge_a},
-        edge_b{edge_b}, vertex_to_face{false}, normal{normal} {}
+        edge_b{edge_b}, vertex_to_face{false}, normal{normal}, feature{feature} {}
+};
+
+// contact feature ids: kind of the contact in the two upper bits
+#define FEATURE_FACE 0u
+#define FEATURE_EDGE (1u << 30)
+#define FEATURE_EPA  (2u << 30)
+#define FEATURE_SPECULATIVE (3u << 30)
+
+// how contacts are resolved, chosen per Scene
+enum class PhysicsBackend {
+    IMPULSE, // velocity level impulses + resting contact forces, full steps
+    XPBD     // position based, XPBD_SUBSTEPS substeps per frame
+};
+
+// face of one of the bodies that separates the pair
+struct SepPlane {
+    unsigned face;    // index in get_faces() (U, L, F, R, B, D)
+    bool from_body_a; // face belongs to body A of the pair
+};
+
+// narrow phase data of a pair of bodies kept between frames
+struct PairCache {
+    // faces that separated the pair last time
+    std::array<SepPlane, 2> sep_planes;
+    unsigned sep_planes_count = 0;
+
+    // separating axis found by GJK when no face separates the pair (B towards A)
+    glm::dvec3 sep_axis;
+    bool sep_axis_valid = false;
+
+    // last GJK simplex, used to warm-start the next query
+    gjk::Simplex simplex;
+    // hull vertices last found for A and B, where their support searches start
+    std::array<unsigned, 2> support_hints = {0, 0};
+
+    // contacts of the last frame together with their accumulated impulses
+    std::vector<Contact> manifold;
+
+    // found by the broad phase since the manifolds were last stored
+    bool candidate = false;
 };
 
 class Scene
 {
 public:
-    Scene();
+    explicit Scene(PhysicsBackend backend = PhysicsBackend::IMPULSE);
     ~Scene();
 
     void update(float dt);
     
     glm::mat4 get_camera_transform() const;
-    std::vector<glm::mat4> get_cubes_transform() const;
-    std::vector<unsigned>  get_cube_meshes() const;
-    std::vector<Contact>   get_contacts() const;
-    void process_contacts(const std::vector<Contact> &contacts);
+    // lists for the renderer, valid until the next call of the same getter
+    const std::vector<glm::mat4> &get_cubes_transform() const;
+    const std::vector<unsigned>  &get_cube_meshes() const;
+    const std::vector<unsigned>  &get_mesh_vertex_counts() const;
+    // lookahead: time during which fast pairs that are still apart may meet,
+    // they get speculative contacts (0 = none); valid until the next call
+    std::vector<Contact>         &get_contacts(double lookahead = 0.0);
+    // velocity impulses and split impulse position correction for a step of dt
+    void process_contacts(std::vector<Contact> &contacts, double dt);
+    // contact forces of the resting contacts, applied during the next step
+    void process_resting_contacts(std::vector<Contact> &contacts);
+
+    PhysicsBackend get_backend() const;
+    double get_kinetic_energy() const;
 
     void rotate_camera(float angle_x, float angle_y);
     void apply_action();
 
 private:
+    // integration, contacts and solving for one (sub)step; with locate_events
+    // the step stops at the first impact inside it. Returns the time simulated.
+    double _step(double dt, bool locate_events);
+    // whole frame with the XPBD backend: contacts are found once, then solved in substeps
+    void _step_xpbd(double dt);
+    // keeps contacts of awake pairs for matching in the next frame
+    void _store_manifolds(const std::vector<Contact> &contacts);
+    // signed separation of the pairs that may start touching during dt
+    std::vector<solver::EventFunction> _impact_events(double dt);
+    // earliest time of impact of fast pairs within dt (conservative advancement), dt if none
+    double _time_of_impact(double dt);
+    // broad phase: pairs that may touch within lookahead into _pairs, grouped
+    // by shape cell with the lower shape first, and a cache for each of them
+    void _find_pairs(double lookahead);
+    void _get_pair_contacts(unsigned a, unsigned b, std::vector<Contact> &result);
+    // single contact at the GJK closest points of a pair that is apart, but
+    // may close the gap within lookahead; returns true if added
+    bool _get_speculative_contact(unsigned a, unsigned b, double lookahead, std::vector<Contact> &result);
+    // narrow phase of pairs of bodies with shapes A and B; specialized for
+    // every pair of shapes that can touch, the rest get no contacts
+    template<narrow_phase::Shape A, narrow_phase::Shape B>
+    void _collide(std::span<const std::pair<unsigned, unsigned>> pairs, double lookahead,
+                  std::vector<Contact> &result);
+    using CollideFunction = void (Scene::*)(std::span<const std::pair<unsigned, unsigned>>, double,
+                                            std::vector<Contact> &);
+    template<narrow_phase::Shape A, narrow_phase::Shape B>
+    struct _CollideCell {
+        static constexpr CollideFunction value = &Scene::_collide<A, B>;
+    };
+    static const std::array<CollideFunction, narrow_phase::CELL_COUNT> _collide_table;
+    narrow_phase::Shape _shape_of(unsigned body) const;
+
+    // single contact from GJK/EPA for pairs with a convex polyhedron: at the
+    // closest points if within CONTACT_EPSILON, speculative one within lookahead
+    void _get_convex_contact(unsigned a, unsigned b, double lookahead, std::vector<Contact> &result);
+    // convex polyhedron against a static plane: vertices within CONTACT_EPSILON,
+    // found by walking the hull from its deepest vertex
+    void _get_hull_plane_contacts(unsigned a, unsigned plane, double lookahead, std::vector<Contact> &result);
+    // box against a static plane: contacts at the vertices behind it (at most 4),
+    // a speculative one at the closest vertex if it may get there within lookahead
+    void _get_plane_contacts(unsigned a, unsigned plane, double lookahead, std::vector<Contact> &result);
+    bool _check_sep_plane(const SepPlane &plane, const std::array<glm::dvec4, 6> &faces,
+                          const std::array<glm::dvec3, 8> &vertices) const;
+    // clipping based face contact manifold (at most 4 points), returns count of added contacts
+    unsigned _get_face_contacts(unsigned a, unsigned b,
+                                const std::array<glm::dvec4, 6> &faces_a, const std::array<glm::dvec4, 6> &faces_b,
+                                const std::array<glm::dvec3, 8> &vertices_a, const std::array<glm::dvec3, 8> &vertices_b,
+                                const glm::dvec3 &normal, std::vector<Contact> &result) const;
+    // groups bodies connected by contacts, wakes islands touched by an awake body
+    void _build_islands(const std::vector<Contact> &contacts);
+    // islands with contacts grouped into solver tasks, most expensive first;
+    // islands with more than max_cost contacts are left out (in the frame arena)
+    std::pmr::vector<std::pmr::vector<unsigned>> _island_batches(std::size_t max_cost = SIZE_MAX);
+    // puts islands that stayed slow for TIME_TO_SLEEP to sleep
+    void _update_sleep(double dt);
+    // copies accumulated impulses and forces of persistent contacts (from first) from the last frame
+    void _match_manifold(const PairCache &cache, std::vector<Contact> &result, std::size_t first) const;
+    // sorts the bodies by the Morton code of their position, so bodies close
+    // in space are close in memory; handles and pair caches follow them
+    void _reorder_bodies();
+    // static bodies (planes) have infinite mass and are never awake
+    bool _is_static(unsigned body) const;
+    bool _is_awake(unsigned body) const;
+
     Camera *_camera;
     std::vector<Cube> _cubes;
+    std::vector<Plane> _planes;
+    PhysicsBackend _backend;
+
+    // bodies move in _cubes when reordered, a handle (index at creation) stays
+    std::vector<unsigned> _body_index;  // handle -> index in _cubes
+    std::vector<unsigned> _body_handle; // index in _cubes -> handle
+    std::vector<Cube> _reordered_cubes; // spare storage the bodies are sorted into
+    unsigned _frames_since_reorder = 0;
+
+    // per-pair narrow phase cache, keyed by (body A, body B)
+    std::map<std::pair<unsigned, unsigned>, PairCache> _pair_cache;
+
+    // temporaries of a step (solver bodies and constraints, island lists),
+    // dropped at the beginning of the next one
+    FrameArena _frame_arena;
+    // lists kept between steps: cleared, but not freed, so once they are
+    // large enough for the scene the step doesn't allocate them again
+    std::vector<Contact> _contacts;
+    std::array<std::vector<std::pair<unsigned, unsigned>>, narrow_phase::CELL_COUNT> _pairs;
+    broad_phase::Boxes _bounds;        // of the bodies, rebuilt by every _find_pairs()
+    broad_phase::Planes _plane_bounds; // planes don't move, built once
+    std::vector<unsigned> _candidates; // broad phase output for one body
+    std::vector<std::vector<Contact>> _chunk_contacts; // narrow phase output of every task
+    mutable std::vector<glm::mat4> _transforms;
+    mutable std::vector<unsigned> _meshes;
+    mutable std::vector<unsigned> _vertex_counts;
+
+    // contact graph islands of the current step
+    std::vector<islands::Island> _islands;
+    ThreadPool _thread_pool;
 
     // camera position in spherical coordinates (radians)
     float _camera_phi = glm::pi<float>() / 4.0f;
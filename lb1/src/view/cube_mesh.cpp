@@ -7,10 +7,29 @@ CubeMesh::CubeMesh(glm::vec3 size)
     _make_mesh(size.x / 2.0, size.y / 2.0, size.z / 2.0);
 }
 
+CubeMesh::CubeMesh(const std::vector<glm::vec3> &triangles)
+{
+    // flat shading: every triangle gets a color from its normal
+    std::vector<float> vertices;
+    vertices.reserve(triangles.size() * 6);
+    for(std::size_t i = 0; i + 2 < triangles.size(); i += 3) {
+        const glm::vec3 normal = glm::normalize(glm::cross(triangles[i + 1] - triangles[i],
+                                                           triangles[i + 2] - triangles[i]));
+        const glm::vec3 color = normal * 0.3f + 0.6f;
+        for(std::size_t k = i; k < i + 3; k++) {
+            vertices.insert(vertices.end(), {triangles[k].x, triangles[k].y, triangles[k].z,
+                                             color.r, color.g, color.b});
+        }
+    }
+    _vertex_count = vertices.size() / 6;
+    _upload(vertices);
+}
+
 CubeMesh::CubeMesh(CubeMesh &&another)
 {
     _VAO = another._VAO;
     _VBO = another._VBO;
+    _vertex_count = another._vertex_count;
 }
 
 void CubeMesh::_make_mesh(float l, float w, float h)
@@ -60,6 +79,11 @@ void CubeMesh::_make_mesh(float l, float w, float h)
          l,  w,  h, 0.0f, 0.0f, 1.0f,
     };
 
+    _upload(vertices);
+}
+
+void CubeMesh::_upload(const std::vector<float> &vertices)
+{
     glGenVertexArrays(1, &_VAO);
     glBindVertexArray(_VAO);
 
@@ -83,3 +107,8 @@ unsigned CubeMesh::get_vao() const
 {
     return _VAO;
 }
+
+unsigned CubeMesh::get_vertex_count() const
+{
+    return _vertex_count;
+}
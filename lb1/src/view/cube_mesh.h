@@ -1,14 +1,20 @@
 #pragma once
+#include <vector>
 #include <glm/glm.hpp>
 
 class CubeMesh {
 
 public:
     CubeMesh(glm::vec3 size = {1.0f, 1.0f, 1.0f});
+    // any closed mesh: three points per triangle, counter-clockwise from outside
+    explicit CubeMesh(const std::vector<glm::vec3> &triangles);
     CubeMesh(CubeMesh &&another);
 
     unsigned get_vao() const;
+    unsigned get_vertex_count() const;
 private:
     unsigned int _VAO, _VBO;
+    unsigned int _vertex_count = 36;
     void _make_mesh(float l, float w, float h);
+    void _upload(const std::vector<float> &vertices);
 };
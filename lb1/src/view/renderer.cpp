@@ -45,20 +45,26 @@ void Renderer::_prepare_opengl()
     glUniformMatrix4fv(_shader_data.projection_transform, 1, GL_FALSE, glm::value_ptr(projection));
 }
 
-void Renderer::render(const Scene &scene)
+void Renderer::capture(const Scene &scene, RenderFrame &frame)
+{
+    frame.camera_transform = scene.get_camera_transform();
+    frame.transforms       = scene.get_cubes_transform();
+    frame.meshes           = scene.get_cube_meshes();
+    frame.vertex_counts    = scene.get_mesh_vertex_counts();
+}
+
+void Renderer::render(const RenderFrame &frame)
 {
     // clear buffers
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
     // load data to the shader
     glUseProgram(_shader);
-    glUniformMatrix4fv(_shader_data.camera_transform, 1, GL_FALSE, glm::value_ptr(scene.get_camera_transform()));
+    glUniformMatrix4fv(_shader_data.camera_transform, 1, GL_FALSE, glm::value_ptr(frame.camera_transform));
 
-    auto cube_pos = scene.get_cubes_transform();
-    auto cube_meshes = scene.get_cube_meshes();
-    for(std::size_t i = 0; i < cube_pos.size(); ++i) {
-        glUniformMatrix4fv(_shader_data.model_transform, 1, GL_FALSE, glm::value_ptr(cube_pos[i]));
-        _draw_mesh(cube_meshes[i], 36);
+    for(std::size_t i = 0; i < frame.transforms.size(); ++i) {
+        glUniformMatrix4fv(_shader_data.model_transform, 1, GL_FALSE, glm::value_ptr(frame.transforms[i]));
+        _draw_mesh(frame.meshes[i], frame.vertex_counts[i]);
     }
 
     // swap buffers (actually display the frame)
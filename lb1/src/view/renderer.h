@@ -1,15 +1,28 @@
 #pragma once
 #include <GLFW/glfw3.h>
+#include <vector>
+#include <glm/glm.hpp>
 #include "../model/scene.h"
 #include "cube_mesh.h"
 
+// everything drawn in one frame, copied out of the scene so that it can be
+// drawn while the scene already computes the next one
+struct RenderFrame {
+    glm::mat4 camera_transform;
+    std::vector<glm::mat4> transforms;
+    std::vector<unsigned>  meshes;
+    std::vector<unsigned>  vertex_counts;
+};
+
 class Renderer
 {
 public:
     Renderer(GLFWwindow *window);
     ~Renderer();
 
-    void render(const Scene &scene);
+    // copies what render() needs out of the scene, reusing the frame's storage
+    static void capture(const Scene &scene, RenderFrame &frame);
+    void render(const RenderFrame &frame);
 private:
     void _prepare_opengl();
 
@@ -0,0 +1,42 @@
+#include <boost/test/unit_test.hpp>
+#include <cstdint>
+#include <vector>
+#include "../src/compute/arena.h"
+
+BOOST_AUTO_TEST_SUITE(frame_arena)
+
+BOOST_AUTO_TEST_CASE(allocations_are_aligned_and_reset)
+{
+    FrameArena arena(1024);
+    void *first = arena.allocate(3, 1);
+    void *aligned = arena.allocate(64, 64);
+    BOOST_TEST(reinterpret_cast<std::uintptr_t>(aligned) % 64 == 0u);
+    BOOST_TEST(arena.used() >= 67u);
+
+    // everything is dropped at once, the buffer is handed out again
+    arena.reset();
+    BOOST_TEST(arena.used() == 0u);
+    BOOST_TEST(arena.allocate(3, 1) == first);
+}
+
+BOOST_AUTO_TEST_CASE(buffer_grows_to_the_peak_use)
+{
+    FrameArena arena(256);
+    {
+        std::pmr::vector<double> values(&arena);
+        for(int i = 0; i < 1000; i++)
+            values.push_back(i);
+        BOOST_TEST(values[999] == 999.0);
+    }
+    const std::size_t peak = arena.used();
+    BOOST_TEST(peak > 256u);
+
+    // the overflowing step made the next buffer large enough for all of it
+    arena.reset();
+    BOOST_TEST(arena.capacity() >= peak);
+    std::pmr::vector<double> values(&arena);
+    values.reserve(1000);
+    BOOST_TEST(arena.used() <= arena.capacity());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
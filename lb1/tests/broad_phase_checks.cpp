@@ -0,0 +1,54 @@
+#include <boost/test/unit_test.hpp>
+#include "../src/compute/broad_phase.h"
+
+BOOST_AUTO_TEST_SUITE(float_broad_phase)
+
+BOOST_AUTO_TEST_CASE(overlapping_boxes)
+{
+    // more boxes than lanes, so the padding of the last group is crossed
+    broad_phase::Boxes boxes;
+    for(unsigned i = 0; i < BROAD_PHASE_LANES + 3; i++)
+        broad_phase::add(boxes, glm::dvec3(i, 0.0, 0.0), glm::dvec3(i + 1.5, 1.0, 1.0));
+
+    for(unsigned i = 0; i < boxes.count; i++) {
+        std::vector<unsigned> result;
+        broad_phase::overlapping(boxes, i, result);
+        // only the next box overlaps, boxes before i are never listed
+        std::vector<unsigned> expected;
+        if(i + 1 < boxes.count)
+            expected.push_back(i + 1);
+        BOOST_TEST(result == expected);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(rounding_keeps_touching_boxes)
+{
+    // bounds that are not floats are rounded outwards, never inwards
+    broad_phase::Boxes boxes;
+    broad_phase::add(boxes, glm::dvec3(0.0), glm::dvec3(0.1));
+    broad_phase::add(boxes, glm::dvec3(0.1, 0.0, 0.0), glm::dvec3(0.2, 0.1, 0.1));
+    std::vector<unsigned> result;
+    broad_phase::overlapping(boxes, 0, result);
+    BOOST_TEST(result == std::vector<unsigned>{1});
+}
+
+BOOST_AUTO_TEST_CASE(boxes_touching_planes)
+{
+    broad_phase::Planes planes;
+    broad_phase::add(planes, glm::dvec4(0.0, 0.0, 1.0, 0.0));             // z <= 0
+    broad_phase::add(planes, glm::dvec4(0.0, 0.0, -1.0, -5.0));           // z >= -5
+    broad_phase::add(planes, glm::dvec4(0.6, 0.0, 0.8, -0.1));            // inclined
+
+    broad_phase::Boxes boxes;
+    broad_phase::add(boxes, glm::dvec3(-0.5, -0.5, -0.2), glm::dvec3(0.5, 0.5, 0.8)); // through z = 0
+    broad_phase::add(boxes, glm::dvec3(-0.5, -0.5, 1.0), glm::dvec3(0.5, 0.5, 2.0));  // above
+
+    std::vector<unsigned> result;
+    broad_phase::touching(boxes, 0, planes, result);
+    BOOST_TEST(result == (std::vector<unsigned>{0, 1, 2}));
+    result.clear();
+    broad_phase::touching(boxes, 1, planes, result);
+    BOOST_TEST(result == std::vector<unsigned>{1});
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,76 @@
+#include <boost/test/unit_test.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/ext/scalar_constants.hpp>
+#include "../src/compute/gjk.h"
+#include "../src/model/cube.h"
+
+namespace
+{
+    // unit box at rest, turned by angle about z
+    Cube unit_box(const glm::dvec3 &position, double angle = 0.0)
+    {
+        Cube box(position, glm::dvec3(1.0), 1.0);
+        box.set_state(position, glm::angleAxis(angle, glm::dvec3(0.0, 0.0, 1.0)), glm::dvec3(0.0), glm::dvec3(0.0));
+        return box;
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(gjk_epa)
+
+BOOST_AUTO_TEST_CASE(distance_between_separated_boxes)
+{
+    const Cube a = unit_box({0.0, 0.0, 0.0});
+    const Cube b = unit_box({3.0, 0.0, 0.0});
+    gjk::Simplex simplex;
+    const gjk::Result result = gjk::distance(a, b, simplex);
+    BOOST_TEST(!result.intersecting);
+    BOOST_TEST(result.distance == 2.0, boost::test_tools::tolerance(1e-9));
+    BOOST_TEST(result.normal.x == -1.0, boost::test_tools::tolerance(1e-9));
+    BOOST_TEST(result.point_a.x == 0.5, boost::test_tools::tolerance(1e-9));
+    BOOST_TEST(result.point_b.x == 2.5, boost::test_tools::tolerance(1e-9));
+}
+
+BOOST_AUTO_TEST_CASE(distance_to_a_turned_box)
+{
+    // the edge of the turned box is sqrt(2)/2 from its center
+    const Cube a = unit_box({0.0, 0.0, 0.0});
+    const Cube b = unit_box({2.0, 0.0, 0.0}, glm::pi<double>() / 4.0);
+    gjk::Simplex simplex;
+    const gjk::Result result = gjk::distance(a, b, simplex);
+    BOOST_TEST(!result.intersecting);
+    BOOST_TEST(result.distance == 1.5 - std::sqrt(0.5), boost::test_tools::tolerance(1e-9));
+}
+
+BOOST_AUTO_TEST_CASE(warm_started_query_gives_the_same_result)
+{
+    const Cube a = unit_box({0.0, 0.0, 0.0});
+    const Cube b = unit_box({1.2, 0.7, -0.3}, 0.3);
+    gjk::Simplex simplex;
+    const gjk::Result cold = gjk::distance(a, b, simplex);
+    const gjk::Result warm = gjk::distance(a, b, simplex);
+    BOOST_TEST(warm.distance == cold.distance, boost::test_tools::tolerance(1e-9));
+    BOOST_TEST(warm.iterations <= cold.iterations);
+}
+
+BOOST_AUTO_TEST_CASE(penetration_depth_of_overlapping_boxes)
+{
+    const Cube a = unit_box({0.0, 0.0, 0.0});
+    const Cube b = unit_box({0.8, 0.1, 0.0});
+    gjk::Simplex simplex;
+    const gjk::Result result = gjk::collide(a, b, simplex);
+    BOOST_TEST(result.intersecting);
+    BOOST_TEST(result.distance == 0.0);
+    BOOST_TEST(result.depth == 0.2, boost::test_tools::tolerance(1e-9));
+    BOOST_TEST(result.normal.x == -1.0, boost::test_tools::tolerance(1e-9));
+}
+
+BOOST_AUTO_TEST_CASE(touching_boxes_have_no_depth)
+{
+    const Cube a = unit_box({0.0, 0.0, 0.0});
+    const Cube b = unit_box({1.0, 0.0, 0.0});
+    gjk::Simplex simplex;
+    const gjk::Result result = gjk::collide(a, b, simplex);
+    BOOST_TEST(result.distance + result.depth <= 1e-9);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,25 @@
+#include "../src/view/cube_mesh.h"
+
+// the checks run without an OpenGL context: bodies get meshes that are
+// never uploaded, everything else is the code of the application
+CubeMesh::CubeMesh(glm::vec3) : _VAO{0}, _VBO{0}
+{
+}
+
+CubeMesh::CubeMesh(const std::vector<glm::vec3> &triangles) : _VAO{0}, _VBO{0}, _vertex_count(triangles.size())
+{
+}
+
+CubeMesh::CubeMesh(CubeMesh &&another) : _VAO{another._VAO}, _VBO{another._VBO}, _vertex_count{another._vertex_count}
+{
+}
+
+unsigned CubeMesh::get_vao() const
+{
+    return _VAO;
+}
+
+unsigned CubeMesh::get_vertex_count() const
+{
+    return _vertex_count;
+}
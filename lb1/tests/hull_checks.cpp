@@ -0,0 +1,77 @@
+#include <boost/test/unit_test.hpp>
+#include <stdexcept>
+#include "../src/compute/hull.h"
+
+namespace tt = boost::test_tools;
+
+namespace
+{
+    // unit cube centered at center, with a point inside it that the hull drops
+    std::vector<glm::dvec3> unit_cube_points(const glm::dvec3 &center)
+    {
+        std::vector<glm::dvec3> points;
+        for(const double x : {-0.5, 0.5})
+            for(const double y : {-0.5, 0.5})
+                for(const double z : {-0.5, 0.5})
+                    points.push_back(center + glm::dvec3(x, y, z));
+        points.push_back(center + glm::dvec3(0.1, -0.2, 0.3));
+        return points;
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(convex_hull)
+
+BOOST_AUTO_TEST_CASE(unit_cube_topology)
+{
+    const hull::Hull cube(unit_cube_points({1.0, 2.0, 3.0}));
+    BOOST_TEST(cube.vertices().size() == 8u);
+    BOOST_TEST(cube.triangles().size() == 12u);
+    for(const auto &neighbors : cube.neighbors()) {
+        // the 3 edges of the cube, maybe diagonals of the faces around the vertex
+        BOOST_TEST(neighbors.size() >= 3u);
+        BOOST_TEST(neighbors.size() <= 6u);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(unit_cube_mass_properties)
+{
+    const hull::Hull cube(unit_cube_points({1.0, 2.0, 3.0}));
+    BOOST_TEST(cube.volume() == 1.0, tt::tolerance(1e-12));
+    BOOST_TEST(cube.center().x == 1.0, tt::tolerance(1e-12));
+    BOOST_TEST(cube.center().y == 2.0, tt::tolerance(1e-12));
+    BOOST_TEST(cube.center().z == 3.0, tt::tolerance(1e-12));
+    BOOST_TEST(cube.radius() == std::sqrt(0.75), tt::tolerance(1e-12));
+
+    // m (1 + 1) / 12 on the diagonal, like the inertia tensor of a box body
+    const glm::dmat3x3 inertia = cube.inertia_tensor(6.0);
+    for(int i = 0; i < 3; i++) {
+        for(int j = 0; j < 3; j++) {
+            if(i == j)
+                BOOST_TEST(inertia[i][j] == 1.0, tt::tolerance(1e-12));
+            else
+                BOOST_TEST(std::abs(inertia[i][j]) < 1e-12);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(support_by_hill_climbing)
+{
+    const hull::Hull cube(unit_cube_points({0.0, 0.0, 0.0}));
+    for(const glm::dvec3 direction : {glm::dvec3(1.0, 1.0, 1.0), glm::dvec3(-1.0, 0.2, -0.3),
+                                      glm::dvec3(0.1, -1.0, 0.7)}) {
+        const glm::dvec3 expected = glm::sign(direction) * 0.5;
+        // from every start vertex the climb ends at the same corner
+        for(unsigned start = 0; start < cube.vertices().size(); start++) {
+            const glm::dvec3 found = cube.vertices()[cube.support(direction, start)];
+            BOOST_TEST(glm::length(found - expected) < 1e-12);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(flat_points_are_rejected)
+{
+    const std::vector<glm::dvec3> square = {{0.0, 0.0, 0.0}, {1.0, 0.0, 0.0}, {1.0, 1.0, 0.0}, {0.0, 1.0, 0.0}};
+    BOOST_CHECK_THROW(hull::Hull{square}, std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
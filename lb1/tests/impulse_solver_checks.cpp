@@ -0,0 +1,150 @@
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <vector>
+#include "../src/compute/impulse_solver.h"
+
+namespace tt = boost::test_tools;
+
+namespace
+{
+    // unit box of mass 1, or an immovable body
+    impulse_solver::Body box(const glm::dvec3 &velocity)
+    {
+        return {velocity, glm::dvec3(0.0), 1.0, glm::dmat3x3(6.0)};
+    }
+
+    impulse_solver::Body immovable()
+    {
+        return {glm::dvec3(0.0), glm::dvec3(0.0), 0.0, glm::dmat3x3(0.0)};
+    }
+
+    impulse_solver::Constraint contact(unsigned a, unsigned b, const glm::dvec3 &normal,
+                                       const glm::dvec3 &ra, const glm::dvec3 &rb)
+    {
+        impulse_solver::Constraint c;
+        c.body_a = a;
+        c.body_b = b;
+        c.normal = normal;
+        c.ra = ra;
+        c.rb = rb;
+        c.impulse = 0.0;
+        return c;
+    }
+
+    double approach_speed(std::span<const impulse_solver::Body> bodies, const impulse_solver::Constraint &c)
+    {
+        const auto &a = bodies[c.body_a];
+        const auto &b = bodies[c.body_b];
+        const glm::dvec3 va = a.velocity + glm::cross(a.angular_velocity, c.ra);
+        const glm::dvec3 vb = b.velocity + glm::cross(b.angular_velocity, c.rb);
+        return -glm::dot(c.normal, va - vb);
+    }
+
+    // a row of count boxes moving into each other, each also lying on an
+    // immovable body of its own (as the scene does for planes)
+    void row(unsigned count, std::vector<impulse_solver::Body> &bodies,
+             std::vector<impulse_solver::Constraint> &constraints)
+    {
+        for(unsigned i = 0; i < count; i++)
+            bodies.push_back(box({(i % 2) ? -1.0 : 1.0, 0.0, -0.5 - 0.001 * i}));
+        for(unsigned i = 0; i + 1 < count; i++)
+            constraints.push_back(contact(i + 1, i, {1.0, 0.0, 0.0}, {-0.5, 0.0, 0.0}, {0.5, 0.0, 0.0}));
+        for(unsigned i = 0; i < count; i++) {
+            bodies.push_back(immovable());
+            constraints.push_back(contact(i, bodies.size() - 1, {0.0, 0.0, 1.0}, {0.0, 0.0, -0.5}, glm::dvec3(0.0)));
+        }
+        for(auto &c : constraints)
+            impulse_solver::prepare(bodies, c, 0.0, 0.0);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(sequential_impulses)
+
+BOOST_AUTO_TEST_CASE(box_landing_on_four_corners_stops)
+{
+    std::vector<impulse_solver::Body> bodies = {box({0.0, 0.0, -2.0}), immovable()};
+    std::vector<impulse_solver::Constraint> constraints;
+    for(const double x : {-0.5, 0.5})
+        for(const double y : {-0.5, 0.5})
+            constraints.push_back(contact(0, 1, {0.0, 0.0, 1.0}, {x, y, -0.5}, {x, y, 0.0}));
+    for(auto &c : constraints)
+        impulse_solver::prepare(bodies, c, 0.0, 0.0);
+
+    impulse_solver::solve(bodies, constraints, 100, 1e-12);
+    BOOST_TEST(std::abs(bodies[0].velocity.z) < 1e-9);
+    BOOST_TEST(glm::length(bodies[0].angular_velocity) < 1e-9);
+    double total = 0.0;
+    for(const auto &c : constraints) {
+        BOOST_TEST(c.impulse >= 0.0);
+        total += c.impulse;
+    }
+    BOOST_TEST(total == 2.0, tt::tolerance(1e-9));
+    BOOST_TEST(bodies[0].linear_impulse.z == 2.0, tt::tolerance(1e-9));
+}
+
+BOOST_AUTO_TEST_CASE(restitution_and_separating_contacts)
+{
+    std::vector<impulse_solver::Body> bodies = {box({0.0, 0.0, -2.0}), immovable(), box({0.0, 0.0, 1.0})};
+    std::vector<impulse_solver::Constraint> constraints = {
+        contact(0, 1, {0.0, 0.0, 1.0}, {0.0, 0.0, -0.5}, glm::dvec3(0.0)),
+        contact(2, 1, {0.0, 0.0, 1.0}, {0.0, 0.0, -0.5}, glm::dvec3(0.0)),
+    };
+    for(auto &c : constraints)
+        impulse_solver::prepare(bodies, c, 0.5, 0.1);
+
+    impulse_solver::solve(bodies, constraints);
+    // half of the approach speed comes back
+    BOOST_TEST(bodies[0].velocity.z == 1.0, tt::tolerance(1e-9));
+    // a body moving away is never pulled back
+    BOOST_TEST(constraints[1].impulse == 0.0);
+    BOOST_TEST(bodies[2].velocity.z == 1.0);
+}
+
+BOOST_AUTO_TEST_CASE(colors_share_no_bodies)
+{
+    std::vector<impulse_solver::Body> bodies;
+    std::vector<impulse_solver::Constraint> constraints;
+    row(600, bodies, constraints);
+
+    const impulse_solver::Coloring coloring = impulse_solver::color(constraints, bodies.size());
+    std::vector<unsigned> seen(constraints.size(), 0);
+    for(const auto &color : coloring.colors) {
+        std::vector<unsigned> used(bodies.size(), 0);
+        for(const unsigned i : color) {
+            seen[i]++;
+            BOOST_TEST(used[constraints[i].body_a]++ == 0u);
+            BOOST_TEST(used[constraints[i].body_b]++ == 0u);
+        }
+    }
+    for(const unsigned i : coloring.rest)
+        seen[i]++;
+    BOOST_TEST(std::all_of(seen.begin(), seen.end(), [](unsigned count) { return count == 1; }));
+}
+
+BOOST_AUTO_TEST_CASE(colored_solve_does_not_depend_on_threads)
+{
+    // 1199 contacts, more than a chunk of the thread pool per color
+    std::vector<impulse_solver::Body> bodies;
+    std::vector<impulse_solver::Constraint> constraints;
+    row(600, bodies, constraints);
+    const impulse_solver::Coloring coloring = impulse_solver::color(constraints, bodies.size());
+
+    std::vector<impulse_solver::Body> bodies_one = bodies, bodies_many = bodies;
+    std::vector<impulse_solver::Constraint> constraints_one = constraints, constraints_many = constraints;
+    ThreadPool one(1), many(3);
+    impulse_solver::solve_colored(bodies_one, constraints_one, coloring, one, 200, 1e-12);
+    impulse_solver::solve_colored(bodies_many, constraints_many, coloring, many, 200, 1e-12);
+
+    for(std::size_t i = 0; i < bodies.size(); i++) {
+        BOOST_TEST((bodies_one[i].velocity == bodies_many[i].velocity));
+        BOOST_TEST((bodies_one[i].angular_velocity == bodies_many[i].angular_velocity));
+    }
+    for(std::size_t i = 0; i < constraints.size(); i++) {
+        BOOST_TEST(constraints_one[i].impulse == constraints_many[i].impulse);
+        BOOST_TEST(constraints_one[i].impulse >= 0.0);
+        // every contact stopped approaching
+        BOOST_TEST(approach_speed(bodies_one, constraints_one[i]) < 1e-6);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
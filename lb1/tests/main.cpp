@@ -0,0 +1,3 @@
+// behaviour checks of the physics modules, run by ctest (no window needed)
+#define BOOST_TEST_MODULE PhysSym checks
+#include <boost/test/included/unit_test.hpp>
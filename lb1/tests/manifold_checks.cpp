@@ -0,0 +1,82 @@
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <cmath>
+#include <glm/ext/scalar_constants.hpp>
+#include "../src/compute/manifold.h"
+
+namespace tt = boost::test_tools;
+
+namespace
+{
+    // regular polygon of count points in the z = 0 plane
+    manifold::Polygon regular_polygon(unsigned count)
+    {
+        manifold::Polygon polygon;
+        for(unsigned i = 0; i < count; i++) {
+            const double angle = 2.0 * glm::pi<double>() * i / count;
+            polygon.features[polygon.size] = i;
+            polygon.points[polygon.size++] = {std::cos(angle), std::sin(angle), 0.0};
+        }
+        return polygon;
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(contact_manifold)
+
+BOOST_AUTO_TEST_CASE(reduction_to_four_points)
+{
+    const manifold::Polygon octagon = regular_polygon(8);
+    std::array<double, MAX_POLYGON_POINTS> depths = {0.1, 0.1, 0.1, 0.3, 0.1, 0.1, 0.1, 0.1};
+    std::array<unsigned, MAX_MANIFOLD_POINTS> selected;
+    const unsigned count = manifold::reduce(octagon, depths, {0.0, 0.0, 1.0}, selected);
+    BOOST_TEST(count == 4u);
+
+    // the deepest point comes first, the others are distinct points of the polygon
+    BOOST_TEST(selected[0] == 3u);
+    std::array<unsigned, MAX_MANIFOLD_POINTS> sorted = selected;
+    std::sort(sorted.begin(), sorted.end());
+    BOOST_TEST(std::adjacent_find(sorted.begin(), sorted.end()) == sorted.end());
+    BOOST_TEST(sorted.back() < octagon.size);
+
+    // they span a quad, not a sliver: at least the area of the square inscribed
+    // in every other vertex of the octagon (2) is expected of the best choice
+    auto area = [&](unsigned i, unsigned j, unsigned k) {
+        const auto &p = octagon.points;
+        return std::abs(glm::cross(p[j] - p[i], p[k] - p[i]).z) / 2.0;
+    };
+    double best = 0.0;
+    const std::array<std::array<unsigned, 3>, 4> triangles = {{{0, 1, 2}, {0, 1, 3}, {0, 2, 3}, {1, 2, 3}}};
+    for(const auto &[i, j, k] : triangles)
+        best = std::max(best, area(selected[i], selected[j], selected[k]));
+    BOOST_TEST(best >= 1.0);
+}
+
+BOOST_AUTO_TEST_CASE(small_polygons_are_kept)
+{
+    const manifold::Polygon triangle = regular_polygon(3);
+    std::array<double, MAX_POLYGON_POINTS> depths = {};
+    std::array<unsigned, MAX_MANIFOLD_POINTS> selected;
+    BOOST_TEST(manifold::reduce(triangle, depths, {0.0, 0.0, 1.0}, selected) == 3u);
+}
+
+BOOST_AUTO_TEST_CASE(clipping_by_a_side_plane)
+{
+    // square of side 2 clipped by x <= 0.5: 4 points, two of them new
+    manifold::Polygon square;
+    for(const glm::dvec3 point : {glm::dvec3(-1.0, -1.0, 0.0), glm::dvec3(1.0, -1.0, 0.0),
+                                  glm::dvec3(1.0, 1.0, 0.0), glm::dvec3(-1.0, 1.0, 0.0)}) {
+        square.features[square.size] = square.size;
+        square.points[square.size++] = point;
+    }
+    const manifold::Polygon clipped = manifold::clip(square, {1.0, 0.0, 0.0, -0.5}, 2);
+    BOOST_TEST(clipped.size == 4u);
+    unsigned created = 0;
+    for(unsigned i = 0; i < clipped.size; i++) {
+        BOOST_TEST(clipped.points[i].x <= 0.5 + 1e-12);
+        if(clipped.features[i] >> 4 == 3u)
+            created++;
+    }
+    BOOST_TEST(created == 2u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
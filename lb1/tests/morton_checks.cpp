@@ -0,0 +1,41 @@
+#include <boost/test/unit_test.hpp>
+#include <vector>
+#include "../src/compute/morton.h"
+
+BOOST_AUTO_TEST_SUITE(morton_order)
+
+BOOST_AUTO_TEST_CASE(bits_are_spread)
+{
+    BOOST_TEST(morton::spread(0u) == 0u);
+    BOOST_TEST(morton::spread(1u) == 1u);
+    BOOST_TEST(morton::spread(0b101u) == 0b1000001u);
+    // every one of the MORTON_BITS bits lands at a multiple of 3, higher bits are dropped
+    BOOST_TEST(morton::spread((1u << MORTON_BITS) - 1) == 0x1249249249249249ull);
+    BOOST_TEST(morton::spread(1u << MORTON_BITS) == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(codes_interleave_the_axes)
+{
+    const glm::dvec3 min(0.0), max(1.0);
+    // the highest cell along x, y and z sets the top bit of its axis
+    const std::uint64_t top = std::uint64_t(1) << (3 * (MORTON_BITS - 1));
+    BOOST_TEST(morton::encode({1.0, 0.0, 0.0}, min, max) == 0x1249249249249249ull);
+    BOOST_TEST(morton::encode({0.5, 0.0, 0.0}, min, max) == top);
+    BOOST_TEST(morton::encode({0.0, 0.5, 0.0}, min, max) == top << 1);
+    BOOST_TEST(morton::encode({0.0, 0.0, 0.5}, min, max) == top << 2);
+}
+
+BOOST_AUTO_TEST_CASE(sort_follows_the_curve)
+{
+    // the four quadrants of a square in Z order, each given twice so equal
+    // codes have to keep their index order
+    const std::vector<glm::dvec3> positions = {
+        {1.0, 1.0, 0.0}, {0.0, 0.0, 0.0}, {1.0, 0.0, 0.0}, {0.0, 1.0, 0.0},
+        {1.0, 1.0, 0.0}, {0.0, 0.0, 0.0}, {1.0, 0.0, 0.0}, {0.0, 1.0, 0.0},
+    };
+    std::vector<unsigned> order(positions.size());
+    morton::sort(positions, order);
+    BOOST_TEST(order == (std::vector<unsigned>{1, 5, 2, 6, 3, 7, 0, 4}));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
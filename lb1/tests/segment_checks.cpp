@@ -0,0 +1,90 @@
+#include <boost/test/unit_test.hpp>
+#include "../src/compute/segment.h"
+
+namespace tt = boost::test_tools;
+
+BOOST_AUTO_TEST_SUITE(segment_closest_points)
+
+BOOST_AUTO_TEST_CASE(crossing_segments)
+{
+    const auto result = segment::closest_points({-1.0, 0.0, 0.0}, {1.0, 0.0, 0.0},
+                                                {0.0, -1.0, 1.0}, {0.0, 1.0, 1.0});
+    BOOST_TEST(result.s == 0.5, tt::tolerance(1e-12));
+    BOOST_TEST(result.t == 0.5, tt::tolerance(1e-12));
+    BOOST_TEST(result.distance2 == 1.0, tt::tolerance(1e-12));
+}
+
+BOOST_AUTO_TEST_CASE(closest_points_at_the_ends)
+{
+    const auto result = segment::closest_points({0.0, 0.0, 0.0}, {1.0, 0.0, 0.0},
+                                                {2.0, -1.0, 0.0}, {2.0, 1.0, 0.0});
+    BOOST_TEST(result.s == 1.0);
+    BOOST_TEST(result.t == 0.5, tt::tolerance(1e-12));
+    BOOST_TEST(result.distance2 == 1.0, tt::tolerance(1e-12));
+}
+
+BOOST_AUTO_TEST_CASE(parallel_segments)
+{
+    // overlapping along x: any pair of points over the overlap is closest
+    const auto result = segment::closest_points({0.0, 0.0, 0.0}, {2.0, 0.0, 0.0},
+                                                {1.0, 1.0, 0.0}, {3.0, 1.0, 0.0});
+    BOOST_TEST(result.distance2 == 1.0, tt::tolerance(1e-12));
+    BOOST_TEST(result.point_a.x >= 1.0 - 1e-12);
+    BOOST_TEST(result.point_a.x <= 2.0 + 1e-12);
+    BOOST_TEST(result.point_b.x == result.point_a.x, tt::tolerance(1e-12));
+
+    // apart along x: the nearest ends
+    const auto apart = segment::closest_points({0.0, 0.0, 0.0}, {1.0, 0.0, 0.0},
+                                               {3.0, 0.0, 0.0}, {2.0, 0.0, 0.0});
+    BOOST_TEST(apart.s == 1.0);
+    BOOST_TEST(apart.t == 1.0);
+    BOOST_TEST(apart.distance2 == 1.0, tt::tolerance(1e-12));
+}
+
+BOOST_AUTO_TEST_CASE(degenerate_segments)
+{
+    const auto point_segment = segment::closest_points({1.0, 1.0, 1.0}, {1.0, 1.0, 1.0},
+                                                       {0.0, 0.0, 0.0}, {2.0, 0.0, 0.0});
+    BOOST_TEST(point_segment.s == 0.0);
+    BOOST_TEST(point_segment.t == 0.5, tt::tolerance(1e-12));
+    BOOST_TEST(point_segment.distance2 == 2.0, tt::tolerance(1e-12));
+
+    const auto segment_point = segment::closest_points({0.0, 0.0, 0.0}, {2.0, 0.0, 0.0},
+                                                       {3.0, 0.0, 0.0}, {3.0, 0.0, 0.0});
+    BOOST_TEST(segment_point.s == 1.0);
+    BOOST_TEST(segment_point.distance2 == 1.0, tt::tolerance(1e-12));
+
+    const auto two_points = segment::closest_points({0.0, 0.0, 0.0}, {0.0, 0.0, 0.0},
+                                                    {0.0, 3.0, 4.0}, {0.0, 3.0, 4.0});
+    BOOST_TEST(two_points.distance2 == 25.0, tt::tolerance(1e-12));
+}
+
+BOOST_AUTO_TEST_CASE(batch_matches_single_pairs)
+{
+    const glm::dvec3 segments[SEGMENT_LANES][4] = {
+        {{-1.0, 0.0, 0.0}, {1.0, 0.0, 0.0}, {0.0, -1.0, 1.0}, {0.0, 1.0, 1.0}},
+        {{0.0, 0.0, 0.0}, {2.0, 0.0, 0.0}, {1.0, 1.0, 0.0}, {3.0, 1.0, 0.0}},
+        {{1.0, 1.0, 1.0}, {1.0, 1.0, 1.0}, {0.0, 0.0, 0.0}, {2.0, 0.0, 0.0}},
+        {{0.3, -0.2, 0.5}, {1.1, 0.4, -0.7}, {-0.5, 0.9, 0.2}, {0.6, -0.3, 0.8}},
+    };
+    segment::Batch batch;
+    for(unsigned l = 0; l < SEGMENT_LANES; l++) {
+        const auto &[p0, q0, p1, q1] = segments[l];
+        for(unsigned k = 0; k < 3; k++) {
+            batch.start_a[k][l] = p0[k];
+            batch.dir_a[k][l] = q0[k] - p0[k];
+            batch.start_b[k][l] = p1[k];
+            batch.dir_b[k][l] = q1[k] - p1[k];
+        }
+    }
+    segment::closest_points(batch);
+    for(unsigned l = 0; l < SEGMENT_LANES; l++) {
+        const auto &[p0, q0, p1, q1] = segments[l];
+        const auto single = segment::closest_points(p0, q0, p1, q1);
+        BOOST_TEST(batch.s[l] == single.s, tt::tolerance(1e-12));
+        BOOST_TEST(batch.t[l] == single.t, tt::tolerance(1e-12));
+        BOOST_TEST(batch.distance2[l] == single.distance2, tt::tolerance(1e-12));
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,48 @@
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+#include "../src/compute/solver.h"
+#include "../src/model/cube.h"
+
+namespace tt = boost::test_tools;
+
+BOOST_AUTO_TEST_SUITE(root_finding)
+
+BOOST_AUTO_TEST_CASE(cube_root_of_two)
+{
+    auto f = [](double x) { return x * x * x - 2.0; };
+    const double root = solver::find_root(f, 0.0, 2.0, f(0.0), f(2.0), 1e-10);
+    BOOST_TEST(root == std::cbrt(2.0), tt::tolerance(1e-9));
+    // the end on the side of a: f has the sign it had at a
+    BOOST_TEST(f(root) <= 0.0);
+}
+
+BOOST_AUTO_TEST_CASE(steep_function_converges)
+{
+    // a plain chord method keeps one end fixed and crawls here, Illinois doesn't
+    auto f = [](double x) { return std::exp(20.0 * x) - 2.0; };
+    const double root = solver::find_root(f, 1.0, 0.0, f(1.0), f(0.0), 1e-10);
+    BOOST_TEST(root == std::log(2.0) / 20.0, tt::tolerance(1e-8));
+    BOOST_TEST(f(root) >= 0.0);
+}
+
+BOOST_AUTO_TEST_CASE(step_ends_at_the_first_event)
+{
+    // falling at 10 m/s for 0.01 s without gravity: the event is negative only
+    // while z is between 0.92 and 0.98, the step has to stop when z reaches 0.98
+    Cube cube(glm::dvec3(0.0, 0.0, 1.0), glm::dvec3(1.0), 1.0);
+    cube.set_state({0.0, 0.0, 1.0}, glm::dquat(1.0, 0.0, 0.0, 0.0), {0.0, 0.0, -10.0}, glm::dvec3(0.0));
+    Cube *objects[] = {&cube};
+    const std::vector<solver::EventFunction> events = {[&] {
+        const double z = cube.get_position().z;
+        return (z - 0.92) * (z - 0.98);
+    }};
+    const std::function<void(Cube&, double)> method = [](Cube &object, double dt) {
+        solver::euler_solver(object, dt, dt);
+    };
+
+    const double simulated = solver::solve_with_events<Cube>(objects, 0.01, method, events, 1e-9);
+    BOOST_TEST(simulated == 0.002, tt::tolerance(1e-6));
+    BOOST_TEST(cube.get_position().z == 0.98, tt::tolerance(1e-6));
+}
+
+BOOST_AUTO_TEST_SUITE_END()